@@ -0,0 +1,35 @@
+#include "alloccounter.h"
+
+#if !defined(NDEBUG) && !defined(TRACK_ALLOCATIONS)
+#define TRACK_ALLOCATIONS
+#endif
+
+#ifdef TRACK_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<unsigned long long> allocations(0);
+
+static void* countedAlloc(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+unsigned long long allocation_count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+#else
+unsigned long long allocation_count() {
+    return 0;
+}
+#endif
\ No newline at end of file
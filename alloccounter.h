@@ -0,0 +1,16 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+// Debug builds replace the global operator new to count heap allocations, so
+// loops that must stay allocation-free can assert it:
+//
+//     unsigned long long before = allocation_count();
+//     ... hot loop ...
+//     assert(allocation_count() == before);
+//
+// With NDEBUG the counter is compiled out and always returns 0, unless
+// TRACK_ALLOCATIONS is defined (optimized builds that still want the count,
+// such as tools/bench.cpp).
+unsigned long long allocation_count();
+
+#endif // ALLOCCOUNTER_H
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "assetloader.h"
+#include <allegro5/allegro_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+AssetLoader& AssetLoader::instance() {
+    static AssetLoader loader;
+    return loader;
+}
+
+AssetLoader::AssetLoader() : nextJob(0), doneCount(0), stopping(false) {
+}
+
+AssetLoader::~AssetLoader() {
+    // Only joins; by now Allegro may be shut down, so assets are left alone
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void AssetLoader::queueBitmap(const char* path) {
+    jobs.push_back({ path, State::Queued, nullptr });
+}
+
+void AssetLoader::start() {
+    // Decoding is CPU-bound and reads are latency-bound, so a few threads
+    // beyond the core count still help on slow disks
+    size_t count = std::min<size_t>(jobs.size(), std::max(2u, std::thread::hardware_concurrency()));
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+void AssetLoader::workerLoop() {
+    // Worker threads have no display, so ask for memory bitmaps explicitly.
+    // Linear filtering is kept when the bitmap is converted later.
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR);
+
+    for (;;) {
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || nextJob >= jobs.size()) return;
+            index = nextJob++;
+        }
+
+        // The job list is fixed once workers run, so reading it unlocked is safe
+        ALLEGRO_BITMAP* result = al_load_bitmap(jobs[index].path);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs[index].result = result;
+            jobs[index].state = State::Done;
+            doneCount++;
+        }
+        jobDone.notify_all();
+    }
+}
+
+void AssetLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+
+    for (Job& job : jobs) {
+        if (job.state == State::Done && job.result) {
+            al_destroy_bitmap(job.result);
+        }
+    }
+    jobs.clear();
+}
+
+bool AssetLoader::bitmapsReady() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Job& job : jobs) {
+        if (job.state == State::Queued) return false;
+    }
+    return true;
+}
+
+float AssetLoader::progress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.empty() ? 1.0f : (float)doneCount / jobs.size();
+}
+
+void AssetLoader::waitForProgress(double seconds) {
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t done = doneCount;
+    jobDone.wait_for(lock, std::chrono::duration<double>(seconds), [&] {
+        return doneCount != done || doneCount == jobs.size();
+    });
+}
+
+AssetLoader::Job* AssetLoader::find(const char* path) {
+    for (Job& job : jobs) {
+        if (job.state != State::Taken && strcmp(job.path, path) == 0) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetLoader::takeBitmap(const char* path, ALLEGRO_BITMAP*& bitmap) {
+    std::unique_lock<std::mutex> lock(mutex);
+    Job* job = find(path);
+    if (!job) return false;
+
+    // Never started (stopped early): nothing will decode it, let the caller load it
+    if (job->state == State::Queued && workers.empty()) return false;
+
+    jobDone.wait(lock, [job] { return job->state == State::Done; });
+    bitmap = job->result;
+    job->state = State::Taken;
+    job->result = nullptr;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <allegro5/allegro.h>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Decodes images on a pool of worker threads that starts at launch, so disk
+// reads and PNG decoding overlap display creation and each other.
+// Bitmaps are decoded as memory bitmaps (workers have no display); whoever
+// takes one converts it to a video bitmap on the main thread.
+class AssetLoader {
+public:
+    static AssetLoader& instance();
+
+    // Queue every asset first, then start(). Paths must outlive the loader.
+    void queueBitmap(const char* path);
+    void start();
+    // Joins the workers and destroys every asset nobody took
+    void stop();
+
+    bool bitmapsReady() const; // Every queued bitmap is decoded
+    float progress() const;    // Fraction of all queued assets decoded
+    // Blocks until another asset finishes or the timeout expires
+    void waitForProgress(double seconds);
+
+    // Hands over the decoded memory bitmap for path, waiting for it if it is
+    // still in flight; bitmap is null if decoding failed. Returns false if path
+    // was never queued or was already taken, so the caller loads it itself.
+    bool takeBitmap(const char* path, ALLEGRO_BITMAP*& bitmap);
+
+private:
+    enum class State { Queued, Done, Taken };
+
+    struct Job {
+        const char* path;
+        State state;
+        ALLEGRO_BITMAP* result;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    size_t nextJob;
+    size_t doneCount;
+    bool stopping;
+    mutable std::mutex mutex;
+    std::condition_variable jobDone;
+
+    AssetLoader();
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    void workerLoop();
+    Job* find(const char* path);
+};
+
+#endif // ASSETLOADER_H
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "batchenv.h"
+#include "coin.h"
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+HighwayEnv::HighwayEnv(const HighwayConfig& config, unsigned long long maxTicks)
+    : player(0, 0, SCREEN_HEIGHT), highway(player, 0, config), maxTicks(maxTicks), observation(),
+    snapshot(highway.getSnapshotCapacity()) {
+    player.reset();
+    observe();
+}
+
+const Observation& HighwayEnv::reset(uint64_t seed) {
+    player.reset();
+    highway.reset(seed);
+    observe();
+    return observation;
+}
+
+StepResult HighwayEnv::step(int action) {
+    int previousScore = highway.getScore();
+
+    player.steer(action, highway.getStepScale());
+    player.update();
+    highway.update();
+    highway.checkCollisions();
+    observe();
+
+    StepResult result;
+    result.observation = &observation;
+    result.reward = highway.getScore() - previousScore;
+    result.truncated = !highway.isGameOver && highway.getTick() >= maxTicks;
+    result.done = highway.isGameOver || result.truncated;
+    return result;
+}
+
+const Observation& HighwayEnv::copyFrom(const HighwayEnv& other) {
+    assert(other.highway.getSnapshotCapacity() <= snapshot.size() && "environments differ in size");
+    size_t size = other.highway.saveSnapshot(snapshot.data());
+    highway.restoreSnapshot(snapshot.data(), size);
+    observe();
+    return observation;
+}
+
+static int laneAt(float centerX) {
+    int lane = (int)((centerX - FIRST_LANE_X) / LANE_WIDTH);
+    return std::min(std::max(lane, 0), LANE_COUNT - 1);
+}
+
+void HighwayEnv::observe() {
+    observation.playerX = player.x;
+    observation.playerLane = laneAt(player.x + player.frameWidth / 2.0f);
+    observation.level = highway.getLevel();
+    observation.score = highway.getScore();
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        observation.obstacleGap[lane] = SCREEN_HEIGHT;
+        observation.coinGap[lane] = SCREEN_HEIGHT;
+    }
+
+    // Only things whose top is above the bike's bottom are still ahead
+    const float playerBottom = player.y + player.frameHeight;
+    const ObstacleArray& obstacles = highway.getObstacles();
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        if (obstacles.y[i] >= playerBottom) continue;
+        float gap = std::max(0.0f, player.y - (obstacles.y[i] + Obstacle::HEIGHT));
+        float& nearest = observation.obstacleGap[laneAt(obstacles.x[i] + Obstacle::WIDTH / 2.0f)];
+        nearest = std::min(nearest, gap);
+    }
+
+    const CoinArray& coins = highway.getCoins();
+    for (size_t i = 0; i < coins.size(); i++) {
+        if (coins.collected[i] || coins.y[i] >= playerBottom) continue;
+        float gap = std::max(0.0f, player.y - (coins.y[i] + Coin::HEIGHT));
+        float& nearest = observation.coinGap[laneAt(coins.x[i] + Coin::WIDTH / 2.0f)];
+        nearest = std::min(nearest, gap);
+    }
+}
+
+void BatchStats::add(const Highway& highway, bool wasTruncated) {
+    int score = highway.getScore();
+    minScore = episodes == 0 ? score : std::min(minScore, score);
+    maxScore = episodes == 0 ? score : std::max(maxScore, score);
+    episodes++;
+    if (wasTruncated) truncated++;
+    ticks += highway.getTick();
+    totalScore += score;
+    totalLevel += highway.getLevel();
+    totalCoins += highway.coinCollected;
+    if (highway.getLevel() >= LEVEL_COUNT) reachedMaxLevel++;
+}
+
+void BatchStats::merge(const BatchStats& other) {
+    if (other.episodes == 0) return;
+    minScore = episodes == 0 ? other.minScore : std::min(minScore, other.minScore);
+    maxScore = episodes == 0 ? other.maxScore : std::max(maxScore, other.maxScore);
+    episodes += other.episodes;
+    truncated += other.truncated;
+    ticks += other.ticks;
+    reachedMaxLevel += other.reachedMaxLevel;
+    totalScore += other.totalScore;
+    totalLevel += other.totalLevel;
+    totalCoins += other.totalCoins;
+}
+
+// Steps one worker's environments until the batch runs out of episodes
+static void run_worker(std::vector<std::unique_ptr<HighwayEnv>>& envs, const BatchOptions& options,
+    Policy policy, std::atomic<unsigned long long>& nextEpisode, BatchStats& stats) {
+    std::vector<const Observation*> observations(envs.size(), nullptr);
+    size_t active = 0;
+
+    // Give every environment a first episode; the active ones are kept at
+    // the front so finished slots drop out of the round-robin
+    for (size_t i = 0; i < envs.size(); i++) {
+        unsigned long long episode = nextEpisode.fetch_add(1);
+        if (episode >= options.episodes) break;
+        observations[active] = &envs[active]->reset(options.seed + episode);
+        active++;
+    }
+
+    while (active > 0) {
+        for (size_t i = 0; i < active;) {
+            StepResult result = envs[i]->step(policy(*observations[i]));
+            if (!result.done) {
+                i++;
+                continue;
+            }
+
+            stats.add(envs[i]->getHighway(), result.truncated);
+            unsigned long long episode = nextEpisode.fetch_add(1);
+            if (episode < options.episodes) {
+                observations[i] = &envs[i]->reset(options.seed + episode);
+                i++;
+            }
+            else {
+                active--;
+                std::swap(envs[i], envs[active]);
+                std::swap(observations[i], observations[active]);
+            }
+        }
+    }
+}
+
+BatchStats run_batch(const HighwayConfig& config, const BatchOptions& options, Policy policy) {
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+    int envs = std::max(options.envs, threads);
+
+    // Each worker builds and owns its environments, so they live in memory
+    // that thread touched first
+    std::atomic<unsigned long long> nextEpisode(0);
+    std::vector<BatchStats> workerStats(threads);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        int count = envs / threads + (t < envs % threads ? 1 : 0);
+        workers.emplace_back([&, t, count]() {
+            std::vector<std::unique_ptr<HighwayEnv>> slice;
+            for (int i = 0; i < count; i++) {
+                slice.emplace_back(new HighwayEnv(config, options.maxTicks));
+            }
+            run_worker(slice, options, policy, nextEpisode, workerStats[t]);
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    BatchStats total;
+    for (const BatchStats& stats : workerStats) {
+        total.merge(stats);
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
\ No newline at end of file
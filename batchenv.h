@@ -0,0 +1,97 @@
+#ifndef BATCHENV_H
+#define BATCHENV_H
+
+#include <cstdint>
+#include <vector>
+#include "constants.h"
+#include "environment.h"
+#include "highway.h"
+
+// What a bot sees each tick. Gaps are measured from the top of the bike up
+// to the bottom of the nearest thing ahead in each lane (0 when it is level
+// with the bike, SCREEN_HEIGHT when the lane is empty).
+struct Observation {
+    float playerX;
+    int playerLane;
+    float obstacleGap[LANE_COUNT];
+    float coinGap[LANE_COUNT]; // Uncollected coins only
+    int level;
+    int score;
+};
+
+struct StepResult {
+    const Observation* observation; // Owned by the environment, valid until the next call
+    int reward;     // Score gained this tick (distance, coins and level bonuses)
+    bool done;      // Crashed, or truncated at the tick limit
+    bool truncated; // Done only because of the tick limit
+};
+
+// One Highway wrapped as a training environment: reset(), then step() with
+// an action until done. Allegro-free and allocation-free once constructed,
+// so any number can be stepped in parallel, one thread per instance.
+class HighwayEnv {
+public:
+    enum Action { LEFT = -1, STAY = 0, RIGHT = 1 };
+
+    HighwayEnv(const HighwayConfig& config, unsigned long long maxTicks);
+
+    const Observation& reset(uint64_t seed);
+    StepResult step(int action);
+
+    // Turns this environment into an exact copy of other (same config), for
+    // lookahead search: clone, try actions, compare. A snapshot round trip;
+    // never allocates.
+    const Observation& copyFrom(const HighwayEnv& other);
+
+    const Highway& getHighway() const { return highway; }
+
+private:
+    Player player; // Must be constructed before highway, which keeps a reference
+    Highway highway;
+    unsigned long long maxTicks;
+    Observation observation;
+    std::vector<uint8_t> snapshot; // Scratch for copyFrom()
+
+    void observe();
+
+    HighwayEnv(const HighwayEnv&) = delete;
+    HighwayEnv& operator=(const HighwayEnv&) = delete;
+};
+
+// Picks an action from an observation. Called concurrently from every
+// worker thread, so it must not keep shared state.
+typedef int (*Policy)(const Observation& observation);
+
+struct BatchOptions {
+    int envs = 1024;          // Environments stepped side by side
+    int threads = 0;          // Worker threads; 0 uses every core
+    unsigned long long episodes = 10000;
+    unsigned long long maxTicks = 20000; // Episodes are truncated after this many ticks
+    uint64_t seed = 1;        // Episode n is seeded seed + n, whatever the thread count
+};
+
+// Aggregated results of finished episodes; merging is order-independent so
+// the totals do not depend on how episodes were spread over threads
+struct BatchStats {
+    unsigned long long episodes = 0;
+    unsigned long long truncated = 0;
+    unsigned long long ticks = 0;
+    unsigned long long reachedMaxLevel = 0;
+    long long totalScore = 0;
+    long long totalLevel = 0;
+    long long totalCoins = 0;
+    int minScore = 0;
+    int maxScore = 0;
+    double seconds = 0; // Wall time of the whole batch
+
+    void add(const Highway& highway, bool wasTruncated);
+    void merge(const BatchStats& other);
+};
+
+// Plays options.episodes episodes of config with policy. Each worker owns a
+// slice of the environments and steps them round-robin, claiming a new
+// episode whenever one finishes; workers share nothing but an atomic
+// episode counter.
+BatchStats run_batch(const HighwayConfig& config, const BatchOptions& options, Policy policy);
+
+#endif // BATCHENV_H
\ No newline at end of file
@@ -1,47 +1,54 @@
-#include "bike.h"
-#include "game.h"
-#include <iostream>
-
-Bike::Bike() : image(nullptr), width(100), height(110) {  // Increased to 50x85
-    loadImage();
-}
-
-Bike::~Bike() {
-    if (image) al_destroy_bitmap(image);
-}
-
-void Bike::loadImage() {
-    image = al_load_bitmap("assets/bike.png");
-    if (!image) {
-        std::cerr << "Failed to load bike image\n";
-        image = al_create_bitmap(width, height);
-        al_set_target_bitmap(image);
-        al_clear_to_color(al_map_rgb(0, 255, 0));
-        al_set_target_backbuffer(al_get_current_display());
-    }
-    else {
-        // Scale to desired size while maintaining aspect ratio
-        float scale = std::min((float)width / al_get_bitmap_width(image),
-            (float)height / al_get_bitmap_height(image));
-        int scaled_w = al_get_bitmap_width(image) * scale;
-        int scaled_h = al_get_bitmap_height(image) * scale;
-
-        ALLEGRO_BITMAP* scaled = al_create_bitmap(width, height);
-        al_set_target_bitmap(scaled);
-        al_clear_to_color(al_map_rgba(0, 0, 0, 0)); // Transparent background
-        al_draw_scaled_bitmap(image,
-            0, 0, al_get_bitmap_width(image), al_get_bitmap_height(image),
-            (width - scaled_w) / 2, (height - scaled_h) / 2, scaled_w, scaled_h, 0);
-        al_destroy_bitmap(image);
-        image = scaled;
-        al_set_target_backbuffer(al_get_current_display());
-    }
-}
-
-void Bike::draw(float x, float y) {
-    if (image) {
-        al_draw_bitmap(image, x, y, 0);
-    }
-    else {
-        al_draw_filled_rectangle(x, y, x + width, y + height, al_map_rgb(0, 255, 0));
-    }
\ No newline at end of file
+#include "bike.h"
+#include "assetloader.h"
+#include "game.h"
+#include "spritecache.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+const char* BIKE_IMAGE = "assets/bike.png";
+
+static ALLEGRO_BITMAP* createBikeFallback(int width, int height) {
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    ALLEGRO_BITMAP* image = al_create_bitmap(width, height);
+    al_set_target_bitmap(image);
+    al_clear_to_color(al_map_rgb(0, 255, 0));
+    al_restore_state(&state);
+    return image;
+}
+
+void Bike::queueAssets() {
+    AssetLoader::instance().queueBitmap(BIKE_IMAGE);
+}
+
+Bike::Bike() : image(nullptr), width(100), height(110), scale(1.0f) {  // Increased to 50x85
+    loadImage();
+}
+
+Bike::~Bike() {
+    SpriteCache::instance().release(image);
+}
+
+void Bike::loadImage() {
+    // Scale to desired size while maintaining aspect ratio
+    int scaledWidth = std::max(1, (int)std::lround(width * scale));
+    int scaledHeight = std::max(1, (int)std::lround(height * scale));
+    image = SpriteCache::instance().acquire(BIKE_IMAGE, scaledWidth, scaledHeight,
+        ScaleMode::Fit, createBikeFallback);
+}
+
+void Bike::setScale(float newScale) {
+    SpriteCache::instance().release(image);
+    scale = newScale;
+    loadImage();
+}
+
+void Bike::draw(float x, float y) {
+    if (image) {
+        al_draw_bitmap(image, x, y, 0);
+    }
+    else {
+        al_draw_filled_rectangle(x, y, x + width * scale, y + height * scale, al_map_rgb(0, 255, 0));
+    }
+}
\ No newline at end of file
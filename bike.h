@@ -1,24 +1,32 @@
-#ifndef BIKE_H
-#define BIKE_H
-
-#include <allegro5/allegro.h>
-#include <allegro5/allegro_image.h>
-
-class Bike {
-public:
-    Bike();
-    ~Bike();
-
-    void draw(float x, float y);
-    int getWidth() const { return width; }
-    int getHeight() const { return height; }
-
-private:
-    ALLEGRO_BITMAP* image;
-    int width;
-    int height;
-
-    void loadImage();
-};
-
+#ifndef BIKE_H
+#define BIKE_H
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_image.h>
+
+class Bike {
+public:
+    Bike();
+    ~Bike();
+
+    static void queueAssets(); // Start decoding the sprite in the background
+
+    void draw(float x, float y); // Top-left corner in display pixels
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    ALLEGRO_BITMAP* getImage() const { return image; } // Owned by the sprite cache
+
+    // Re-acquires the sprite pre-scaled for a view drawn at scale times the
+    // logical size. getWidth()/getHeight() stay in logical units.
+    void setScale(float scale);
+
+private:
+    ALLEGRO_BITMAP* image;
+    int width;
+    int height;
+    float scale;
+
+    void loadImage();
+};
+
 #endif // BIKE_H
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "broadphase.h"
+#include <algorithm>
+
+int LaneIndex::laneOf(float x) {
+    int lane = static_cast<int>((x - FIRST_LANE_X) * (1.0f / LANE_WIDTH));
+    if (lane < 0) lane = 0;
+    if (lane >= LANE_COUNT) lane = LANE_COUNT - 1;
+    return lane;
+}
+
+void LaneIndex::reserve(size_t count) {
+    for (auto& lane : lanes) {
+        lane.reserve(count);
+    }
+}
+
+void LaneIndex::clear() {
+    for (auto& lane : lanes) {
+        lane.clear();
+    }
+}
+
+void LaneIndex::build(const float* xs, const float* ys, size_t count, float maxY) {
+    clear();
+    for (size_t i = 0; i < count; i++) {
+        if (ys[i] > maxY) continue;
+        lanes[laneOf(xs[i])].push_back({ ys[i], static_cast<uint32_t>(i) });
+    }
+    for (auto& lane : lanes) {
+        std::sort(lane.begin(), lane.end());
+    }
+}
+
+void LaneIndex::refresh(const float* ys, float maxY) {
+    for (auto& lane : lanes) {
+        // Re-read positions in last tick's order, dropping entities past maxY
+        size_t kept = 0;
+        for (size_t i = 0; i < lane.size(); i++) {
+            Entry entry = { ys[lane[i].index], lane[i].index };
+            if (entry.y > maxY) continue;
+
+            // Only cars that overtook each other since the last tick are out of
+            // order, so this insertion sort is close to linear
+            size_t j = kept++;
+            while (j > 0 && entry < lane[j - 1]) {
+                lane[j] = lane[j - 1];
+                j--;
+            }
+            lane[j] = entry;
+        }
+        lane.resize(kept);
+    }
+}
+
+void LaneIndex::insert(int lane, float y, uint32_t index) {
+    std::vector<Entry>& bucket = lanes[lane];
+    Entry entry = { y, index };
+    bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), entry), entry);
+}
+
+void LaneIndex::query(float left, float right, float minY, float maxY, std::vector<uint32_t>& out) const {
+    int firstLane = laneOf(left);
+    int lastLane = laneOf(right);
+
+    for (int lane = firstLane; lane <= lastLane; lane++) {
+        const std::vector<Entry>& bucket = lanes[lane];
+        Entry probe = { maxY, 0 };
+        for (auto it = std::upper_bound(bucket.begin(), bucket.end(), probe); // First with y < maxY
+            it != bucket.end() && it->y > minY; ++it) {
+            out.push_back(it->index);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.h"
+
+// Broadphase for lane-aligned entities: indices are bucketed by lane and kept
+// sorted by y within each lane, so collision queries only look at the lanes
+// and y-window they care about. Buckets run from the bottom of the road to
+// the top, so entities spawning above the screen are appended at the back
+// instead of shifting the whole bucket.
+class LaneIndex {
+public:
+    // Below this many entities a brute-force batch test beats the broadphase
+    static const size_t MIN_ENTITIES = 32;
+
+    static int laneOf(float x); // Lane whose span contains x (clamped)
+
+    void reserve(size_t count); // Room for count entities in every lane
+    void clear();
+    // Rebuilds the buckets from scratch, skipping entities with y > maxY
+    void build(const float* xs, const float* ys, size_t count, float maxY);
+    // Re-reads the y of every indexed entity and restores the order, dropping
+    // entities with y > maxY. Entities must not have changed lane since they
+    // were indexed; re-add moved ones with insert().
+    void refresh(const float* ys, float maxY);
+    void insert(int lane, float y, uint32_t index);
+
+    // Appends indices of entities in the lanes overlapping [left, right)
+    // whose y lies strictly inside (minY, maxY)
+    void query(float left, float right, float minY, float maxY, std::vector<uint32_t>& out) const;
+
+private:
+    struct Entry {
+        float y;
+        uint32_t index;
+        // Bucket order: further down the road first
+        bool operator<(const Entry& other) const { return y > other.y; }
+    };
+
+    std::vector<Entry> lanes[LANE_COUNT];
+};
+
+#endif // BROADPHASE_H
\ No newline at end of file
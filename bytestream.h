@@ -0,0 +1,43 @@
+#ifndef BYTESTREAM_H
+#define BYTESTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Helpers for flat binary buffers (state snapshots, replay files). Values
+// are stored with memcpy, i.e. in host byte order; every platform the game
+// ships on is little-endian.
+
+template <typename T>
+inline uint8_t* putValue(uint8_t* out, const T& value) {
+    memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+template <typename T>
+inline bool getValue(const uint8_t*& in, const uint8_t* end, T& value) {
+    if ((size_t)(end - in) < sizeof(T)) return false;
+    memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return true;
+}
+
+template <typename T>
+inline uint8_t* putArray(uint8_t* out, const std::vector<T>& values) {
+    size_t bytes = values.size() * sizeof(T);
+    if (bytes) memcpy(out, values.data(), bytes);
+    return out + bytes;
+}
+
+// Reads count elements into values, which must already have the capacity
+template <typename T>
+inline const uint8_t* getArray(const uint8_t* in, size_t count, std::vector<T>& values) {
+    size_t bytes = count * sizeof(T);
+    values.resize(count);
+    if (bytes) memcpy(values.data(), in, bytes);
+    return in + bytes;
+}
+
+#endif // BYTESTREAM_H
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "capture.h"
+#include <allegro5/allegro_image.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Locked frames are read and written as bytes R, G, B, A on every platform
+const int CAPTURE_PIXEL_FORMAT = ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE;
+
+FrameCapture::FrameCapture()
+    : format(Format::PngSequence), width(0), height(0), fps(0), video(nullptr),
+    queueHead(0), queueCount(0), nextSequence(0), nextWrite(0), stopping(false) {
+}
+
+FrameCapture::~FrameCapture() {
+    stop();
+}
+
+FrameCapture::Format FrameCapture::formatForPath(const char* path) {
+    size_t length = strlen(path);
+    if (length >= 4 && strcmp(path + length - 4, ".y4m") == 0) {
+        return Format::Y4m;
+    }
+    return Format::PngSequence;
+}
+
+bool FrameCapture::start(const char* outputPath, Format outputFormat, int frameWidth,
+    int frameHeight, int framesPerSecond, int encoders, int queueDepth) {
+    stop();
+
+    format = outputFormat;
+    path = outputPath;
+    width = frameWidth;
+    height = frameHeight;
+    fps = std::max(1, framesPerSecond);
+    if (format == Format::Y4m) {
+        // 4:2:0 chroma covers 2x2 blocks
+        width &= ~1;
+        height &= ~1;
+    }
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Capture frame size is empty\n";
+        return false;
+    }
+
+    // PNG compression dominates, so one encoder per core; Y4M is mostly a
+    // colour conversion and a write, which two threads keep up with
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    if (encoders <= 0) {
+        encoders = format == Format::Y4m ? 2 : (int)std::min(cores, 8u);
+    }
+    // Enough frames that every encoder is busy and a few more can wait out
+    // a slow write
+    if (queueDepth <= 0) {
+        queueDepth = encoders * 2 + 2;
+    }
+    queueDepth = std::max(queueDepth, encoders);
+
+    if (format == Format::Y4m) {
+        video = fopen(path.c_str(), "wb");
+        if (!video) {
+            std::cerr << "Failed to open capture file: " << path << "\n";
+            return false;
+        }
+        // Full-range BT.601 4:2:0, progressive, square pixels
+        fprintf(video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    }
+
+    // Memory bitmaps in a fixed byte order, so encoders can read them
+    // without a display and converting to YUV needs no per-pixel format checks
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_NEW_BITMAP_PARAMETERS);
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+    al_set_new_bitmap_format(CAPTURE_PIXEL_FORMAT);
+    frames.resize(queueDepth);
+    for (Frame& frame : frames) {
+        frame.bitmap = al_create_bitmap(width, height);
+        frame.sequence = 0;
+        if (format == Format::Y4m) {
+            frame.planes.resize((size_t)width * height * 3 / 2);
+        }
+    }
+    al_restore_state(&state);
+    for (const Frame& frame : frames) {
+        if (!frame.bitmap) {
+            std::cerr << "Failed to create " << queueDepth << " capture frames of "
+                << width << "x" << height << "\n";
+            release();
+            return false;
+        }
+    }
+
+    freeFrames.clear();
+    for (int i = queueDepth - 1; i >= 0; i--) {
+        freeFrames.push_back(i);
+    }
+    queue.assign(queueDepth, -1);
+    queueHead = 0;
+    queueCount = 0;
+    nextSequence = 0;
+    nextWrite = 0;
+    stopping = false;
+    counters = Counters();
+
+    for (int i = 0; i < encoders; i++) {
+        workers.emplace_back(&FrameCapture::workerLoop, this);
+    }
+    std::cout << "Capturing " << width << "x" << height << " at " << fps << " fps to " << path
+        << (format == Format::Y4m ? " (Y4M)" : " (PNG sequence)") << ", " << encoders
+        << " encoders, " << queueDepth << " frames queued at most\n";
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (workers.empty()) return;
+
+    // Encoders only exit once the queue is empty, so nothing submitted is lost
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameQueued.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+    release();
+}
+
+void FrameCapture::release() {
+    for (Frame& frame : frames) {
+        if (frame.bitmap) al_destroy_bitmap(frame.bitmap);
+    }
+    frames.clear();
+    freeFrames.clear();
+    queue.clear();
+    if (video) {
+        fclose(video);
+        video = nullptr;
+    }
+}
+
+ALLEGRO_BITMAP* FrameCapture::acquire(bool wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (frames.empty()) return nullptr;
+    if (freeFrames.empty()) {
+        if (!wait) {
+            counters.dropped++;
+            return nullptr;
+        }
+        counters.waits++;
+        frameFree.wait(lock, [this] { return !freeFrames.empty(); });
+    }
+    int index = freeFrames.back();
+    freeFrames.pop_back();
+    return frames[index].bitmap;
+}
+
+int FrameCapture::findFrame(ALLEGRO_BITMAP* bitmap) const {
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].bitmap == bitmap) return (int)i;
+    }
+    return -1;
+}
+
+void FrameCapture::submit(ALLEGRO_BITMAP* bitmap) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int index = findFrame(bitmap);
+        if (index < 0) return;
+        frames[index].sequence = nextSequence++;
+        queue[(queueHead + queueCount) % queue.size()] = index;
+        queueCount++;
+        counters.submitted++;
+    }
+    frameQueued.notify_one();
+}
+
+bool FrameCapture::captureFrom(ALLEGRO_BITMAP* source) {
+    ALLEGRO_BITMAP* frame = acquire(false);
+    if (!frame) return false;
+
+    int copyWidth = std::min(width, al_get_bitmap_width(source));
+    int copyHeight = std::min(height, al_get_bitmap_height(source));
+    ALLEGRO_LOCKED_REGION* to = al_lock_bitmap(frame, CAPTURE_PIXEL_FORMAT, ALLEGRO_LOCK_WRITEONLY);
+    ALLEGRO_LOCKED_REGION* from = al_lock_bitmap_region(source, 0, 0, copyWidth, copyHeight,
+        CAPTURE_PIXEL_FORMAT, ALLEGRO_LOCK_READONLY);
+    if (to) {
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = (uint8_t*)to->data + (ptrdiff_t)y * to->pitch;
+            int copied = 0;
+            if (from && y < copyHeight) {
+                memcpy(row, (const uint8_t*)from->data + (ptrdiff_t)y * from->pitch, (size_t)copyWidth * 4);
+                copied = copyWidth;
+            }
+            memset(row + (size_t)copied * 4, 0, (size_t)(width - copied) * 4);
+        }
+    }
+    if (from) al_unlock_bitmap(source);
+    if (to) al_unlock_bitmap(frame);
+
+    // Queued either way: a Y4M stream must not skip a sequence number, and
+    // a failed readback shows up as a black frame rather than a gap
+    submit(frame);
+    return to && from;
+}
+
+void FrameCapture::workerLoop() {
+    for (;;) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameQueued.wait(lock, [this] { return queueCount > 0 || stopping; });
+            if (queueCount == 0) return;
+            index = queue[queueHead];
+            queueHead = (queueHead + 1) % queue.size();
+            queueCount--;
+        }
+
+        // The frame belongs to this worker until it goes back on the free list
+        Frame& frame = frames[index];
+        bool written = format == Format::Y4m ? encodeY4m(frame) : encodePng(frame);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (written) counters.written++;
+            else counters.failed++;
+            freeFrames.push_back(index);
+        }
+        frameFree.notify_one();
+    }
+}
+
+bool FrameCapture::encodePng(const Frame& frame) {
+    char name[1024];
+    snprintf(name, sizeof(name), "%s/frame_%06llu.png", path.c_str(), frame.sequence);
+    return al_save_bitmap(name, frame.bitmap);
+}
+
+// Full-range BT.601 in 8.8 fixed point (the JFIF equations)
+static inline uint8_t luma(int r, int g, int b) {
+    return (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+}
+
+static inline uint8_t clampByte(int value) {
+    return (uint8_t)std::min(255, std::max(0, value));
+}
+
+bool FrameCapture::encodeY4m(Frame& frame) {
+    // Convert outside the lock, in parallel with the other encoders
+    bool converted = false;
+    ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(frame.bitmap, CAPTURE_PIXEL_FORMAT,
+        ALLEGRO_LOCK_READONLY);
+    if (region) {
+        uint8_t* yPlane = frame.planes.data();
+        uint8_t* uPlane = yPlane + (size_t)width * height;
+        uint8_t* vPlane = uPlane + (size_t)width * height / 4;
+        for (int y = 0; y < height; y += 2) {
+            const uint8_t* top = (const uint8_t*)region->data + (ptrdiff_t)y * region->pitch;
+            const uint8_t* bottom = top + region->pitch;
+            uint8_t* yTop = yPlane + (size_t)y * width;
+            uint8_t* yBottom = yTop + width;
+            uint8_t* u = uPlane + (size_t)(y / 2) * (width / 2);
+            uint8_t* v = vPlane + (size_t)(y / 2) * (width / 2);
+            for (int x = 0; x < width; x += 2) {
+                const uint8_t* p[4] = { top + x * 4, top + x * 4 + 4, bottom + x * 4, bottom + x * 4 + 4 };
+                yTop[x] = luma(p[0][0], p[0][1], p[0][2]);
+                yTop[x + 1] = luma(p[1][0], p[1][1], p[1][2]);
+                yBottom[x] = luma(p[2][0], p[2][1], p[2][2]);
+                yBottom[x + 1] = luma(p[3][0], p[3][1], p[3][2]);
+
+                // Chroma of the 2x2 block average
+                int r = p[0][0] + p[1][0] + p[2][0] + p[3][0];
+                int g = p[0][1] + p[1][1] + p[2][1] + p[3][1];
+                int b = p[0][2] + p[1][2] + p[2][2] + p[3][2];
+                u[x / 2] = clampByte(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128);
+                v[x / 2] = clampByte(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128);
+            }
+        }
+        al_unlock_bitmap(frame.bitmap);
+        converted = true;
+    }
+
+    // Frames finish out of order across encoders but must be written in
+    // order. A frame that failed to convert still takes its turn, so the
+    // ones after it are not held up forever.
+    std::unique_lock<std::mutex> lock(mutex);
+    frameWritten.wait(lock, [this, &frame] { return nextWrite == frame.sequence; });
+    bool written = false;
+    if (converted) {
+        written = fputs("FRAME\n", video) >= 0 &&
+            fwrite(frame.planes.data(), 1, frame.planes.size(), video) == frame.planes.size();
+    }
+    nextWrite++;
+    lock.unlock();
+    frameWritten.notify_all();
+    return written;
+}
+
+FrameCapture::Counters FrameCapture::getCounters() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void FrameCapture::printStats() const {
+    Counters stats = getCounters();
+    std::cout << "Capture: " << stats.written << " of " << stats.submitted << " frames written";
+    if (stats.failed) std::cout << ", " << stats.failed << " failed";
+    std::cout << ", " << stats.dropped << " dropped (encoders behind), "
+        << stats.waits << " waits for a free frame\n";
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <allegro5/allegro.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records frames to disk without holding up whoever draws them. Each frame is
+// drawn into (or copied to) one of a fixed set of off-screen memory bitmaps
+// and queued; a pool of encoder threads writes the queue out as a numbered
+// PNG sequence or as one raw Y4M video. The set of bitmaps bounds the queue:
+// once the encoders fall behind, acquire() either waits for one to come back
+// (offline capture, every frame kept) or gives up so the frame is dropped and
+// counted (live capture, the game never stalls on the disk).
+class FrameCapture {
+public:
+    enum class Format {
+        PngSequence, // <path>/frame_000000.png, ... (the directory must exist)
+        Y4m          // One YUV 4:2:0 stream, playable and encodable by ffmpeg
+    };
+
+    struct Counters {
+        unsigned long long submitted = 0;
+        unsigned long long written = 0;
+        unsigned long long failed = 0;  // Frames the encoder could not write
+        unsigned long long dropped = 0; // Frames the queue had no room for
+        unsigned long long waits = 0;   // Times acquire() blocked on the encoders
+    };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    // Y4m for a path ending in .y4m, a PNG sequence otherwise
+    static Format formatForPath(const char* path);
+
+    // Allocates every frame bitmap and starts the encoders. Frames are
+    // width x height (Y4M rounds both down to even) at fps frames per second.
+    // encoders and queueDepth of 0 pick defaults from the core count.
+    bool start(const char* path, Format format, int width, int height, int fps,
+        int encoders = 0, int queueDepth = 0);
+    // Writes out everything still queued, then joins the encoders
+    void stop();
+    bool isRunning() const { return !workers.empty(); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // A free frame bitmap to draw the next frame into. If every frame is still
+    // queued, waits for one when wait is set, otherwise counts a dropped frame
+    // and returns null.
+    ALLEGRO_BITMAP* acquire(bool wait);
+    // Queues a frame from acquire() for encoding. It must no longer be the
+    // target bitmap of any thread.
+    void submit(ALLEGRO_BITMAP* frame);
+    // Copies source (normally the backbuffer) into a free frame and queues
+    // it. Never waits; returns false if the frame was dropped or could not
+    // be read back (it is then queued black). A source smaller than the
+    // capture is padded with black, a larger one cropped.
+    bool captureFrom(ALLEGRO_BITMAP* source);
+
+    Counters getCounters() const;
+    void printStats() const;
+
+private:
+    struct Frame {
+        ALLEGRO_BITMAP* bitmap;
+        unsigned long long sequence;
+        std::vector<uint8_t> planes; // Y4M only: Y, then U, then V
+    };
+
+    Format format;
+    std::string path;
+    int width, height;
+    int fps;
+    FILE* video; // Y4M output
+
+    std::vector<Frame> frames;
+    // Indices into frames. Both are sized for every frame up front, so
+    // queueing never allocates.
+    std::vector<int> freeFrames; // Stack
+    std::vector<int> queue;      // Ring, oldest first
+    size_t queueHead, queueCount;
+    unsigned long long nextSequence;
+    unsigned long long nextWrite; // Y4M frames go into the file in order
+    bool stopping;
+    Counters counters;
+
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable frameQueued;
+    std::condition_variable frameFree;
+    std::condition_variable frameWritten;
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    int findFrame(ALLEGRO_BITMAP* bitmap) const;
+    void workerLoop();
+    bool encodePng(const Frame& frame);
+    bool encodeY4m(Frame& frame);
+    void release(); // Destroys the frames and closes the output
+};
+
+#endif // CAPTURE_H
\ No newline at end of file
@@ -1,40 +1,50 @@
-#ifndef COIN_H
-#define COIN_H
-
-#include "highway.h" // Contains GameObject definition
-#include <allegro5/allegro.h>
-
-class Player; // Forward declaration
-
-class Coin : public GameObject {
-public:
-    static constexpr int WIDTH = 20;
-    static constexpr int HEIGHT = 20;
-    static constexpr int COLLISION_PADDING = 5;
-
-    Coin(float x, float y);
-    ~Coin();
-
-    void update() override;
-    void draw() override;
-    bool checkCollision(const Player& player) const;
-
-    float getX() const { return x; }
-    float getY() const { return y; }
-    bool isCollected() const { return collected; }
-    void collect() { collected = true; }
-
-    // New methods for level-based speed control
-    float getSpeed() const { return speed; }
-    void setSpeed(float newSpeed) { speed = newSpeed; }
-
-private:
-    float x, y;
-    float speed = 2.0f; // Default coin speed
-    ALLEGRO_BITMAP* image;
-    bool collected = false;
-
-    void loadImage();
-};
-
+#ifndef COIN_H
+#define COIN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "collision.h"
+#include "parkedlist.h"
+
+class Player; // Forward declaration
+
+class Coin {
+public:
+    static constexpr int WIDTH = 20;
+    static constexpr int HEIGHT = 20;
+    static constexpr int COLLISION_PADDING = 5;
+
+    // Scalar overlap test for a single (uncollected) coin at (x, y)
+    static bool checkCollision(float x, float y, const Player& player);
+
+    static EntityShape getCollisionShape() {
+        return { (float)COLLISION_PADDING, (float)COLLISION_PADDING,
+            (float)(WIDTH - 2 * COLLISION_PADDING), (float)(HEIGHT - 2 * COLLISION_PADDING) };
+    }
+};
+
+// All coins on the highway, stored as parallel arrays
+struct CoinArray {
+    std::vector<float> x, y;
+    std::vector<float> speed;
+    std::vector<uint8_t> collected;
+    ParkedList parked; // Coins off the road, waiting for place()
+
+    size_t size() const { return x.size(); }
+    bool hasParked() const { return !parked.empty(); }
+    void reserve(size_t capacity); // Fixes the pool size; add() never reallocates after this
+    void clear();
+    void add(float startX, float startY, float startSpeed);
+
+    // Scroll step ticks' worth, first parking the coins that left the screen
+    // on the previous tick
+    void update(float step);
+    void parkAll();
+    void collectParked(); // Rebuilds the free list after the arrays were overwritten
+    // Puts the lowest parked coin back on the road. Returns its index, or -1
+    // if every coin is on the road.
+    int place(float newX, float newY, float newSpeed);
+};
+
 #endif // COIN_H
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "collision.h"
+#include "environment.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+// COLLISION_NO_SIMD keeps the kernels scalar on any target, so the fallback
+// can be tested (tools/collidetest.cpp) on machines that have SSE
+#if defined(COLLISION_NO_SIMD)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define COLLISION_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLLISION_SSE 1
+#endif
+
+CollisionBox playerCollisionBox(const Player& player) {
+    CollisionBox box;
+    box.left = player.x + player.collisionOffsetX;
+    box.right = box.left + player.frameWidth - 2 * player.collisionOffsetX;
+    box.top = player.y + player.collisionOffsetY;
+    box.bottom = box.top + player.frameHeight - 2 * player.collisionOffsetY;
+    return box;
+}
+
+// Same operation order as the scalar tests so results match bit for bit:
+// left = x + offset, right = left + size
+static inline bool overlaps(float x, float y, const EntityShape& shape, const CollisionBox& box) {
+    float left = x + shape.offsetX;
+    float right = left + shape.width;
+    float top = y + shape.offsetY;
+    float bottom = top + shape.height;
+    return left < box.right && right > box.left && top < box.bottom && bottom > box.top;
+}
+
+size_t collideBatch(const float* xs, const float* ys, size_t count,
+    const EntityShape& shape, const CollisionBox& box, uint32_t* hitMask) {
+    if (count == 0) return 0;
+
+    memset(hitMask, 0, hitMaskWords(count) * sizeof(uint32_t));
+    size_t hits = 0;
+    size_t i = 0;
+
+#if defined(COLLISION_AVX)
+    const __m256 offX = _mm256_set1_ps(shape.offsetX);
+    const __m256 offY = _mm256_set1_ps(shape.offsetY);
+    const __m256 width = _mm256_set1_ps(shape.width);
+    const __m256 height = _mm256_set1_ps(shape.height);
+    const __m256 boxLeft = _mm256_set1_ps(box.left);
+    const __m256 boxRight = _mm256_set1_ps(box.right);
+    const __m256 boxTop = _mm256_set1_ps(box.top);
+    const __m256 boxBottom = _mm256_set1_ps(box.bottom);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 left = _mm256_add_ps(_mm256_loadu_ps(xs + i), offX);
+        __m256 right = _mm256_add_ps(left, width);
+        __m256 top = _mm256_add_ps(_mm256_loadu_ps(ys + i), offY);
+        __m256 bottom = _mm256_add_ps(top, height);
+
+        __m256 hit = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(left, boxRight, _CMP_LT_OQ), _mm256_cmp_ps(right, boxLeft, _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(top, boxBottom, _CMP_LT_OQ), _mm256_cmp_ps(bottom, boxTop, _CMP_GT_OQ)));
+
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_ps(hit));
+        if (bits) {
+            hitMask[i / 32] |= bits << (i % 32);
+            for (; bits; bits &= bits - 1) hits++;
+        }
+    }
+#elif defined(COLLISION_SSE)
+    const __m128 offX = _mm_set1_ps(shape.offsetX);
+    const __m128 offY = _mm_set1_ps(shape.offsetY);
+    const __m128 width = _mm_set1_ps(shape.width);
+    const __m128 height = _mm_set1_ps(shape.height);
+    const __m128 boxLeft = _mm_set1_ps(box.left);
+    const __m128 boxRight = _mm_set1_ps(box.right);
+    const __m128 boxTop = _mm_set1_ps(box.top);
+    const __m128 boxBottom = _mm_set1_ps(box.bottom);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 left = _mm_add_ps(_mm_loadu_ps(xs + i), offX);
+        __m128 right = _mm_add_ps(left, width);
+        __m128 top = _mm_add_ps(_mm_loadu_ps(ys + i), offY);
+        __m128 bottom = _mm_add_ps(top, height);
+
+        __m128 hit = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(left, boxRight), _mm_cmpgt_ps(right, boxLeft)),
+            _mm_and_ps(_mm_cmplt_ps(top, boxBottom), _mm_cmpgt_ps(bottom, boxTop)));
+
+        uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(hit));
+        if (bits) {
+            hitMask[i / 32] |= bits << (i % 32);
+            for (; bits; bits &= bits - 1) hits++;
+        }
+    }
+#endif
+
+    // Scalar fallback and remainder
+    for (; i < count; i++) {
+        if (overlaps(xs[i], ys[i], shape, box)) {
+            hitMask[i / 32] |= 1u << (i % 32);
+            hits++;
+        }
+    }
+
+    return hits;
+}
+
+// Narrows [enter, exit) to the times the moving interval [a0 + v s, a1 + v s)
+// overlaps the fixed [b0, b1). Boundaries come from the same strict
+// comparisons as overlaps(), so at s = 0 both tests agree exactly.
+static inline void sweepAxis(float a0, float a1, float v, float b0, float b1,
+    float& enter, float& exit) {
+    if (v == 0) {
+        if (!(a0 < b1 && a1 > b0)) exit = enter; // Never overlaps
+        return;
+    }
+    float first = (b0 - a1) / v;
+    float last = (b1 - a0) / v;
+    if (v < 0) std::swap(first, last);
+    enter = std::max(enter, first);
+    exit = std::min(exit, last);
+}
+
+size_t collideSwept(const float* xs, const float* ys, const float* speeds, float step,
+    float maxSpeed, size_t count, const EntityShape& shape, const CollisionBox& from,
+    const CollisionBox& to, uint32_t* hitMask, float* impact) {
+    if (count == 0) return 0;
+
+    // Most entities are nowhere near the ground either player box covers.
+    // The batch kernel rules them out first, with every entity stretched up
+    // by the furthest anything travelled and the ground widened by a pixel,
+    // so only real contenders get the exact test below.
+    const float maxTravel = maxSpeed * step;
+    const EntityShape reachShape = { shape.offsetX, shape.offsetY - maxTravel,
+        shape.width, shape.height + maxTravel };
+    const CollisionBox reach = { std::min(from.left, to.left) - 1, std::min(from.top, to.top) - 1,
+        std::max(from.right, to.right) + 1, std::max(from.bottom, to.bottom) + 1 };
+    if (collideBatch(xs, ys, count, reachShape, reach, hitMask) == 0) return 0;
+
+    // Time runs backwards from the end of the tick (s = 0) to its start
+    // (s = 1), so the player stays at `to` and the end positions are used as
+    // they are; the entity moves up by its travel while the player's own
+    // motion is undone.
+    const float playerBackX = from.left - to.left;
+    const float playerBackY = from.top - to.top;
+    size_t hits = 0;
+    for (size_t word = 0; word < hitMaskWords(count); word++) {
+        for (uint32_t bits = hitMask[word]; bits; bits &= bits - 1) {
+            uint32_t bit = 0;
+            while (!((bits >> bit) & 1u)) bit++;
+            size_t i = word * 32 + bit;
+            assert(speeds[i] <= maxSpeed);
+
+            float left = xs[i] + shape.offsetX;
+            float right = left + shape.width;
+            float top = ys[i] + shape.offsetY;
+            float bottom = top + shape.height;
+            float enter = 0, exit = 1;
+            sweepAxis(left, right, -playerBackX, to.left, to.right, enter, exit);
+            sweepAxis(top, bottom, -speeds[i] * step - playerBackY, to.top, to.bottom, enter, exit);
+            if (enter < exit) {
+                impact[i] = 1 - exit; // Latest s is the earliest time
+                hits++;
+            } else {
+                hitMask[word] &= ~(1u << bit);
+            }
+        }
+    }
+
+    return hits;
+}
\ No newline at end of file
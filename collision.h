@@ -0,0 +1,47 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cstddef>
+#include <cstdint>
+
+class Player;
+
+// Axis-aligned box in screen coordinates
+struct CollisionBox {
+    float left, top, right, bottom;
+};
+
+// Padded player box, computed exactly like the scalar checkCollision functions
+CollisionBox playerCollisionBox(const Player& player);
+
+// Entity box shape: the padded box of an entity at (x, y) spans
+// [x + offsetX, x + offsetX + width) x [y + offsetY, y + offsetY + height)
+struct EntityShape {
+    float offsetX, offsetY;
+    float width, height;
+};
+
+// Number of 32-bit words needed for a hit mask covering count entities
+inline size_t hitMaskWords(size_t count) { return (count + 31) / 32; }
+
+// Tests every entity at (xs[i], ys[i]) against box in one pass (AVX or SSE
+// when the build targets them, scalar otherwise or with COLLISION_NO_SIMD).
+// Bit i of hitMask (word i / 32, bit i % 32) is set when entity i overlaps.
+// hitMask must hold hitMaskWords(count) words. Returns the number of hits.
+size_t collideBatch(const float* xs, const float* ys, size_t count,
+    const EntityShape& shape, const CollisionBox& box, uint32_t* hitMask);
+
+// Swept version for one tick: the player box moves in a straight line from
+// `from` to `to` while entity i moves straight down by speeds[i] * step,
+// ending the tick at (xs[i], ys[i]). Entity i is hit if the two boxes
+// overlap at any time during the tick, however far either moved, and
+// impact[i] is then the earliest such time as a fraction of the tick (0 at
+// its start, 1 at its end). An entity that ends the tick overlapping `to`
+// is always a hit, exactly as collideBatch would report it. No speed may
+// exceed maxSpeed. hitMask and the return value work like collideBatch;
+// impact must hold count floats.
+size_t collideSwept(const float* xs, const float* ys, const float* speeds, float step,
+    float maxSpeed, size_t count, const EntityShape& shape, const CollisionBox& from,
+    const CollisionBox& to, uint32_t* hitMask, float* impact);
+
+#endif // COLLISION_H
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef CONSTANTS_H
+#define CONSTANTS_H
+
+// Screen dimensions and frame rate (shared by the simulation and the renderer,
+// so this header must not depend on Allegro)
+constexpr int SCREEN_WIDTH = 1000;
+constexpr int SCREEN_HEIGHT = 800;
+constexpr int FPS = 80;
+
+// Lane configuration constants
+constexpr int LANE_COUNT = 3;
+constexpr int LANE_WIDTH = 200;
+constexpr int FIRST_LANE_X = 100;
+constexpr int LANE_POSITIONS[LANE_COUNT] = {
+    FIRST_LANE_X,
+    FIRST_LANE_X + LANE_WIDTH,
+    FIRST_LANE_X + 2 * LANE_WIDTH
+};
+
+// Off-screen spot for cars and coins waiting to be reused (they also have
+// speed 0 while parked there)
+constexpr float PARKED_Y = 2 * SCREEN_HEIGHT;
+
+#endif // CONSTANTS_H
\ No newline at end of file
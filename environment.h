@@ -1,19 +1,25 @@
-#ifndef ENVIRONMENT_H
-#define ENVIRONMENT_H
-
-class Player {
-public:
-    float x, y;
-    float velocityX, velocityY;
-    int screen_height;
-    int frameWidth, frameHeight;
-
-    // Collision padding
-    static constexpr float collisionOffsetX = 20.0f;
-    static constexpr float collisionOffsetY = 30.0f;
-
-    Player(float start_x, float start_y, int screen_h);
-    void update();
-};
-
+#ifndef ENVIRONMENT_H
+#define ENVIRONMENT_H
+
+class Player {
+public:
+    float x, y;
+    float velocityX, velocityY;
+    int screen_height;
+    int frameWidth, frameHeight;
+
+    // Collision padding
+    static constexpr float collisionOffsetX = 20.0f;
+    static constexpr float collisionOffsetY = 30.0f;
+
+    static constexpr float STEER_SPEED = 5.0f; // Pixels per FPS-rate tick
+
+    Player(float start_x, float start_y, int screen_h);
+    void update();
+    void reset(); // Back to the starting spot at the bottom centre, standing still
+    // Sets the horizontal velocity for direction -1 (left), 0 or 1 (right);
+    // stepScale is Highway::getStepScale()
+    void steer(int direction, float stepScale) { velocityX = STEER_SPEED * stepScale * direction; }
+};
+
 #endif // ENVIRONMENT_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "framepacer.h"
+#include <iostream>
+
+FramePacer::FramePacer(int maxCatchUp)
+    : maxCatchUp(maxCatchUp > 1 ? maxCatchUp : 1),
+    ticks(0), catchUpTicks(0), skippedTicks(0), frames(0), lateFrames(0) {
+}
+
+int FramePacer::admitTicks(int due) {
+    if (due <= 0) return 0;
+
+    int run = due < maxCatchUp ? due : maxCatchUp;
+    ticks.fetch_add(run, std::memory_order_relaxed);
+    catchUpTicks.fetch_add(run - 1, std::memory_order_relaxed);
+    skippedTicks.fetch_add(due - run, std::memory_order_relaxed);
+    return run;
+}
+
+void FramePacer::frameDone(double seconds, double interval) {
+    frames.fetch_add(1, std::memory_order_relaxed);
+
+    // Half an interval of slack covers timing jitter around the vblank
+    if (seconds > interval * 1.5) {
+        lateFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FramePacer::Counters FramePacer::getCounters() const {
+    Counters counters;
+    counters.ticks = ticks.load(std::memory_order_relaxed);
+    counters.catchUpTicks = catchUpTicks.load(std::memory_order_relaxed);
+    counters.skippedTicks = skippedTicks.load(std::memory_order_relaxed);
+    counters.frames = frames.load(std::memory_order_relaxed);
+    counters.lateFrames = lateFrames.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void FramePacer::printStats() const {
+    Counters counters = getCounters();
+    std::cout << "Frame pacing: " << counters.ticks << " ticks (" << counters.catchUpTicks
+        << " catching up, " << counters.skippedTicks << " skipped), " << counters.frames
+        << " frames (" << counters.lateFrames << " late)\n";
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <atomic>
+
+// Pacing policy for the fixed-rate simulation and the display-rate renderer.
+// When the host stalls, timer ticks pile up; the simulation coalesces them
+// and asks admitTicks() how many to run. At most maxCatchUp are simulated
+// back to back and the rest are dropped, so an overloaded machine slows the
+// game down for a moment instead of falling further and further behind.
+//
+// The counters are atomics: the simulation thread updates the tick ones and
+// the render thread the frame ones, and either may read them.
+class FramePacer {
+public:
+    static const int DEFAULT_MAX_CATCH_UP = 4;
+
+    struct Counters {
+        unsigned long long ticks;         // Ticks simulated
+        unsigned long long catchUpTicks;  // Of those, run late to catch up
+        unsigned long long skippedTicks;  // Due ticks dropped instead
+        unsigned long long frames;        // Frames shown
+        unsigned long long lateFrames;    // Frames that missed their refresh
+    };
+
+    explicit FramePacer(int maxCatchUp = DEFAULT_MAX_CATCH_UP);
+
+    // Simulation thread: due ticks have elapsed since the last batch (1 when
+    // on time). Returns how many of them to simulate now.
+    int admitTicks(int due);
+    // Render thread: a frame took seconds against a refresh interval
+    void frameDone(double seconds, double interval);
+
+    int getMaxCatchUp() const { return maxCatchUp; }
+    Counters getCounters() const;
+    void printStats() const;
+
+private:
+    int maxCatchUp;
+    std::atomic<unsigned long long> ticks;
+    std::atomic<unsigned long long> catchUpTicks;
+    std::atomic<unsigned long long> skippedTicks;
+    std::atomic<unsigned long long> frames;
+    std::atomic<unsigned long long> lateFrames;
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+};
+
+#endif // FRAMEPACER_H
\ No newline at end of file
@@ -1,354 +1,609 @@
-#include "game.h"
-#include "bike.h"
-#include "environment.h"
-#include "highway.h"
-#include <iostream>
-
-ALLEGRO_DISPLAY* display = nullptr;
-ALLEGRO_EVENT_QUEUE* event_queue = nullptr;
-ALLEGRO_TIMER* timer = nullptr;
-ALLEGRO_FONT* font = nullptr;
-ALLEGRO_SAMPLE* game_sound = nullptr;
-ALLEGRO_SAMPLE_INSTANCE* game_sound_instance = nullptr;
-
-bool initialize_allegro() {
-    if (!al_init()) {
-        std::cerr << "Failed to initialize Allegro core!\n";
-        return false;
-    }
-
-    if (!al_init_image_addon()) {
-        std::cerr << "Failed to initialize image addon!\n";
-        return false;
-    }
-
-    if (!al_init_font_addon()) {
-        std::cerr << "Failed to initialize font addon!\n";
-        return false;
-    }
-
-    if (!al_init_ttf_addon()) {
-        std::cerr << "Failed to initialize TTF addon!\n";
-        return false;
-    }
-
-    if (!al_init_primitives_addon()) {
-        std::cerr << "Failed to initialize primitives addon!\n";
-        return false;
-    }
-
-    // Initialize audio addons
-    if (!al_install_audio()) {
-        std::cerr << "Failed to install audio!\n";
-        return false;
-    }
-
-    if (!al_init_acodec_addon()) {
-        std::cerr << "Failed to initialize audio codec addon!\n";
-        return false;
-    }
-
-    // Reserve samples for audio playback
-    if (!al_reserve_samples(1)) {
-        std::cerr << "Failed to reserve audio samples!\n";
-        return false;
-    }
-
-    // Install peripherals
-    if (!al_install_keyboard()) {
-        std::cerr << "Failed to install keyboard!\n";
-        return false;
-    }
-
-    // Create display
-    display = al_create_display(SCREEN_WIDTH, SCREEN_HEIGHT);
-    if (!display) {
-        std::cerr << "Failed to create display!\n";
-        return false;
-    }
-
-    // Create event queue
-    event_queue = al_create_event_queue();
-    if (!event_queue) {
-        std::cerr << "Failed to create event queue!\n";
-        al_destroy_display(display);
-        return false;
-    }
-
-    // Create timer (60 FPS)
-    timer = al_create_timer(1.0 / FPS);
-    if (!timer) {
-        std::cerr << "Failed to create timer!\n";
-        al_destroy_event_queue(event_queue);
-        al_destroy_display(display);
-        return false;
-    }
-
-    // Register event sources
-    al_register_event_source(event_queue, al_get_display_event_source(display));
-    al_register_event_source(event_queue, al_get_keyboard_event_source());
-    al_register_event_source(event_queue, al_get_timer_event_source(timer));
-
-    // Set window title
-    al_set_window_title(display, "Traffic Rider");
-
-    return true;
-}
-
-bool initialize_game() {
-    // Create built-in font
-    font = al_create_builtin_font();
-    if (!font) {
-        std::cerr << "Failed to create built-in font!\n";
-        return false;
-    }
-
-    // Load game sound
-    game_sound = al_load_sample("assets/gamesound.mp3");
-    if (!game_sound) {
-        std::cerr << "Failed to load game sound file! Make sure 'assets/gamesound.mp3' exists.\n";
-        // Continue even if sound loading fails - we'll handle this gracefully
-    }
-    else {
-        // Create a sample instance for better control
-        game_sound_instance = al_create_sample_instance(game_sound);
-        if (!game_sound_instance) {
-            std::cerr << "Failed to create sound instance!\n";
-            al_destroy_sample(game_sound);
-            game_sound = nullptr;
-        }
-        else {
-            // Configure the sound instance
-            al_set_sample_instance_playmode(game_sound_instance, ALLEGRO_PLAYMODE_LOOP);
-            al_attach_sample_instance_to_mixer(game_sound_instance, al_get_default_mixer());
-        }
-    }
-
-    // Seed random number generator
-    srand(static_cast<unsigned>(time(nullptr)));
-
-    return true;
-}
-
-void Alma() {
-    // Create game objects
-    Bike bike;
-    Player player(SCREEN_WIDTH / 2 - bike.getWidth() / 2,
-        SCREEN_HEIGHT - bike.getHeight() - 20,
-        SCREEN_HEIGHT);
-    Highway highway(bike, player);
-
-    // Game state variables
-    bool running = true;
-    bool redraw = true;
-    bool paused = false;
-
-    // Level up notification variables
-    bool showLevelUpMessage = false;
-    int levelUpMessageTimer = 0;
-    int previousLevel = highway.getLevel();
-
-    // Start the game sound if available
-    if (game_sound_instance) {
-        al_play_sample_instance(game_sound_instance);
-    }
-
-    // Start the game timer
-    al_start_timer(timer);
-
-    // Main game loop
-    while (running && !highway.isGameOver) {
-        ALLEGRO_EVENT event;
-        al_wait_for_event(event_queue, &event);
-
-        // Handle events
-        switch (event.type) {
-        case ALLEGRO_EVENT_TIMER:
-            if (!paused) {
-                // Update game state
-                player.update();
-                highway.update();
-                highway.checkCollisions();
-
-                // Check if level has changed
-                if (highway.getLevel() > previousLevel) {
-                    showLevelUpMessage = true;
-                    levelUpMessageTimer = 180; // Show for 3 seconds (60 FPS * 3)
-                    previousLevel = highway.getLevel();
-                }
-
-                // Update level up notification timer
-                if (showLevelUpMessage) {
-                    levelUpMessageTimer--;
-                    if (levelUpMessageTimer <= 0) {
-                        showLevelUpMessage = false;
-                    }
-                }
-
-                redraw = true;
-            }
-            break;
-
-        case ALLEGRO_EVENT_DISPLAY_CLOSE:
-            running = false;
-            break;
-
-        case ALLEGRO_EVENT_KEY_DOWN:
-            switch (event.keyboard.keycode) {
-            case ALLEGRO_KEY_ESCAPE:
-                running = false;
-                break;
-            case ALLEGRO_KEY_LEFT:
-                player.velocityX = -5; // Move left
-                break;
-            case ALLEGRO_KEY_RIGHT:
-                player.velocityX = 5;  // Move right
-                break;
-            case ALLEGRO_KEY_P:
-                paused = !paused;     // Toggle pause
-
-                // Pause/resume music when game is paused/resumed
-                if (game_sound_instance) {
-                    if (paused) {
-                        al_stop_sample_instance(game_sound_instance);
-                    }
-                    else {
-                        al_play_sample_instance(game_sound_instance);
-                    }
-                }
-                break;
-            case ALLEGRO_KEY_M:
-                // Toggle mute/unmute
-                if (game_sound_instance) {
-                    bool is_playing = al_get_sample_instance_playing(game_sound_instance);
-                    if (is_playing) {
-                        al_stop_sample_instance(game_sound_instance);
-                    }
-                    else if (!paused) {
-                        al_play_sample_instance(game_sound_instance);
-                    }
-                }
-                break;
-            }
-            break;
-
-        case ALLEGRO_EVENT_KEY_UP:
-            switch (event.keyboard.keycode) {
-            case ALLEGRO_KEY_LEFT:
-            case ALLEGRO_KEY_RIGHT:
-                player.velocityX = 0;  // Stop horizontal movement
-                break;
-            }
-            break;
-        }
-
-        // Render frame if needed
-        if (redraw && al_is_event_queue_empty(event_queue)) {
-            redraw = false;
-
-            // Clear screen
-            al_clear_to_color(al_map_rgb(0, 0, 0));
-
-            // Draw game elements
-            highway.draw();
-
-            // Draw HUD
-            al_draw_textf(font, al_map_rgb(255, 255, 255), 10, 10, 0,
-                "Score: %d", highway.getScore());
-            al_draw_textf(font, al_map_rgb(255, 255, 255), 10, 30, 0,
-                "Level: %d", highway.getLevel());
-
-            // Display coin count and coins needed for next level
-            if (highway.getLevel() < Highway::MAX_LEVEL) {
-                int coinsNeeded = Highway::COINS_FOR_LEVEL_UP * highway.getLevel() - highway.coinCollected;
-                if (coinsNeeded < 0) coinsNeeded = 0;
-
-                al_draw_textf(font, al_map_rgb(255, 215, 0), 10, 50, 0,
-                    "Coins: %d/%d", highway.coinCollected, Highway::COINS_FOR_LEVEL_UP * highway.getLevel());
-            }
-            else {
-                // At max level, just show coin count
-                al_draw_textf(font, al_map_rgb(255, 215, 0), 10, 50, 0,
-                    "Coins: %d", highway.coinCollected);
-            }
-
-            // Show controls hint
-            al_draw_text(font, al_map_rgb(200, 200, 200), SCREEN_WIDTH - 10, 10, ALLEGRO_ALIGN_RIGHT,
-                "M - Toggle Music");
-
-            // Show level up notification
-            if (showLevelUpMessage) {
-                al_draw_filled_rectangle(
-                    SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2 - 30,
-                    SCREEN_WIDTH / 2 + 120, SCREEN_HEIGHT / 2 + 30,
-                    al_map_rgba(0, 0, 0, 200)
-                );
-                al_draw_textf(font, al_map_rgb(255, 255, 0), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 10,
-                    ALLEGRO_ALIGN_CENTER, "LEVEL UP!");
-                al_draw_textf(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 10,
-                    ALLEGRO_ALIGN_CENTER, "Level %d", highway.getLevel());
-            }
-
-            // Draw pause message if game is paused
-            if (paused) {
-                al_draw_text(font, al_map_rgb(255, 255, 0), SCREEN_WIDTH / 2,
-                    SCREEN_HEIGHT / 2, ALLEGRO_ALIGN_CENTER,
-                    "PAUSED - Press P to continue");
-            }
-
-            // Flip display
-            al_flip_display();
-        }
-    }
-
-    // Stop sound when game is over
-    if (game_sound_instance) {
-        al_stop_sample_instance(game_sound_instance);
-    }
-
-    // Game over screen
-    if (highway.isGameOver) {
-        al_clear_to_color(al_map_rgb(0, 0, 0));
-        al_draw_text(font, al_map_rgb(255, 0, 0), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 50,
-            ALLEGRO_ALIGN_CENTER, "GAME OVER");
-        al_draw_textf(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20,
-            ALLEGRO_ALIGN_CENTER, "Final Score: %d", highway.getScore());
-        al_draw_textf(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 10,
-            ALLEGRO_ALIGN_CENTER, "Level Reached: %d", highway.getLevel());
-        al_draw_textf(font, al_map_rgb(255, 215, 0), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 40,
-            ALLEGRO_ALIGN_CENTER, "Coins Collected: %d", highway.coinCollected);
-        al_flip_display();
-        al_rest(3.0); // Show game over screen for 3 seconds
-    }
-}
-
-void cleanup_game() {
-    // Clean up game-specific resources
-    if (font) {
-        al_destroy_font(font);
-    }
-
-    // Clean up audio resources
-    if (game_sound_instance) {
-        al_destroy_sample_instance(game_sound_instance);
-    }
-    if (game_sound) {
-        al_destroy_sample(game_sound);
-    }
-}
-
-void cleanup_allegro() {
-    // Clean up Allegro resources
-    if (timer) {
-        al_destroy_timer(timer);
-    }
-    if (event_queue) {
-        al_destroy_event_queue(event_queue);
-    }
-    if (display) {
-        al_destroy_display(display);
-    }
-
-    // Uninstall audio
-    al_uninstall_audio();
+#include "game.h"
+#include "alloccounter.h"
+#include "assetloader.h"
+#include "bike.h"
+#include "capture.h"
+#include "environment.h"
+#include "framepacer.h"
+#include "highway.h"
+#include "hud.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "replay.h"
+#include "simthread.h"
+#include "soundeffects.h"
+#include "spritecache.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+ALLEGRO_DISPLAY* display = nullptr;
+ALLEGRO_EVENT_QUEUE* event_queue = nullptr;
+ALLEGRO_TIMER* timer = nullptr;
+ALLEGRO_FONT* font = nullptr;
+ALLEGRO_AUDIO_STREAM* game_music = nullptr;
+
+const char* GAME_SOUND = "assets/gamesound.mp3";
+const char* SPRITE_PACK = "assets/sprites.pack"; // Built by tools/packer.cpp
+// The music is decoded a buffer at a time as it plays: about 0.4 s of audio
+// in flight instead of the whole track
+const size_t MUSIC_BUFFERS = 4;
+const unsigned int MUSIC_BUFFER_SAMPLES = 4096;
+
+// Cold-start reference for the time-to-first-frame report
+static std::chrono::steady_clock::time_point launch_time;
+
+static bool use_sprite_pack() {
+    return al_filename_exists(SPRITE_PACK) && SpriteCache::instance().usePack(SPRITE_PACK);
+}
+
+bool initialize_allegro() {
+    launch_time = std::chrono::steady_clock::now();
+
+    if (!al_init()) {
+        std::cerr << "Failed to initialize Allegro core!\n";
+        return false;
+    }
+
+    if (!al_init_image_addon()) {
+        std::cerr << "Failed to initialize image addon!\n";
+        return false;
+    }
+
+    if (!al_init_font_addon()) {
+        std::cerr << "Failed to initialize font addon!\n";
+        return false;
+    }
+
+    if (!al_init_primitives_addon()) {
+        std::cerr << "Failed to initialize primitives addon!\n";
+        return false;
+    }
+
+    // Initialize audio addons
+    if (!al_install_audio()) {
+        std::cerr << "Failed to install audio!\n";
+        return false;
+    }
+
+    if (!al_init_acodec_addon()) {
+        std::cerr << "Failed to initialize audio codec addon!\n";
+        return false;
+    }
+
+    // Only creates the default voice and mixer; the music stream and the
+    // sound effect voices are attached to it directly
+    if (!al_reserve_samples(0)) {
+        std::cerr << "Failed to reserve audio samples!\n";
+        return false;
+    }
+
+    // Every decoder is ready, so start reading assets now; the loader threads
+    // overlap display creation and each other. A sprite pack already holds
+    // every sprite at the window's starting size, so with one nothing is
+    // decoded (other sizes are still loaded from the PNGs on demand).
+    AssetLoader& loader = AssetLoader::instance();
+    if (!use_sprite_pack()) {
+        Bike::queueAssets();
+        Renderer::queueAssets();
+    }
+    loader.start();
+
+    // Install peripherals
+    if (!al_install_keyboard()) {
+        std::cerr << "Failed to install keyboard!\n";
+        return false;
+    }
+
+    // Create display (resizable; the renderer letterboxes and re-scales sprites).
+    // Frames are paced by vsync and interpolated between logic ticks.
+    al_set_new_display_flags(ALLEGRO_RESIZABLE);
+    al_set_new_display_option(ALLEGRO_VSYNC, 1, ALLEGRO_SUGGEST);
+    display = al_create_display(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!display) {
+        std::cerr << "Failed to create display!\n";
+        return false;
+    }
+
+    // Create event queue
+    event_queue = al_create_event_queue();
+    if (!event_queue) {
+        std::cerr << "Failed to create event queue!\n";
+        al_destroy_display(display);
+        return false;
+    }
+
+    // Create the logic tick timer (the simulation sets the final rate)
+    timer = al_create_timer(1.0 / FPS);
+    if (!timer) {
+        std::cerr << "Failed to create timer!\n";
+        al_destroy_event_queue(event_queue);
+        al_destroy_display(display);
+        return false;
+    }
+
+    // Register event sources
+    al_register_event_source(event_queue, al_get_display_event_source(display));
+    al_register_event_source(event_queue, al_get_keyboard_event_source());
+    // The timer drives the simulation thread, which has its own queue
+
+    // Set window title
+    al_set_window_title(display, "Traffic Rider");
+
+    return true;
+}
+
+// Progress bar shown until every sprite is decoded
+static void show_loading_screen() {
+    AssetLoader& loader = AssetLoader::instance();
+    while (!loader.bitmapsReady()) {
+        al_clear_to_color(al_map_rgb(0, 0, 0));
+        al_draw_text(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20,
+            ALLEGRO_ALIGN_CENTER, "Loading...");
+        al_draw_rectangle(SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2, SCREEN_WIDTH / 2 + 150,
+            SCREEN_HEIGHT / 2 + 12, al_map_rgb(255, 255, 255), 1);
+        al_draw_filled_rectangle(SCREEN_WIDTH / 2 - 148, SCREEN_HEIGHT / 2 + 2,
+            SCREEN_WIDTH / 2 - 148 + 296 * loader.progress(), SCREEN_HEIGHT / 2 + 10,
+            al_map_rgb(255, 215, 0));
+        al_flip_display();
+
+        loader.waitForProgress(1.0 / 30);
+    }
+}
+
+bool initialize_game() {
+    // Create built-in font
+    font = al_create_builtin_font();
+    if (!font) {
+        std::cerr << "Failed to create built-in font!\n";
+        return false;
+    }
+
+    // Opening the stream only reads the first buffers; the rest is decoded
+    // on the audio thread while it plays
+    game_music = al_load_audio_stream(GAME_SOUND, MUSIC_BUFFERS, MUSIC_BUFFER_SAMPLES);
+    if (!game_music) {
+        std::cerr << "Failed to load game sound file! Make sure 'assets/gamesound.mp3' exists.\n";
+        // Continue even if sound loading fails - we'll handle this gracefully
+    }
+    else {
+        al_set_audio_stream_playmode(game_music, ALLEGRO_PLAYMODE_LOOP);
+        al_set_audio_stream_playing(game_music, false);
+        al_attach_audio_stream_to_mixer(game_music, al_get_default_mixer());
+    }
+
+    show_loading_screen();
+    return true;
+}
+
+static void set_music_playing(bool playing) {
+    if (game_music) {
+        al_set_audio_stream_playing(game_music, playing);
+    }
+}
+
+// Score, level and coin counters plus the level-up and pause banners
+static void drawHud(HudLayer& hud, const WorldSnapshot& world, bool paused, double now) {
+    hud.draw(world, now);
+
+    // Show level up notification
+    if (world.levelUpTicks > 0) {
+        al_draw_filled_rectangle(
+            SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2 - 30,
+            SCREEN_WIDTH / 2 + 120, SCREEN_HEIGHT / 2 + 30,
+            al_map_rgba(0, 0, 0, 200)
+        );
+        al_draw_textf(font, al_map_rgb(255, 255, 0), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 10,
+            ALLEGRO_ALIGN_CENTER, "LEVEL UP!");
+        al_draw_textf(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 10,
+            ALLEGRO_ALIGN_CENTER, "Level %d", world.level);
+    }
+
+    // Draw pause message if game is paused
+    if (paused) {
+        al_draw_text(font, al_map_rgb(255, 255, 0), SCREEN_WIDTH / 2,
+            SCREEN_HEIGHT / 2, ALLEGRO_ALIGN_CENTER,
+            "PAUSED - Press P to continue");
+    }
+}
+
+// Profiler overlay: min/avg/p99 per phase over the last few seconds, plus
+// the pacing counters since launch
+static void drawProfilerOverlay(const Profiler& profiler, const FramePacer& pacer,
+    const HudLayer& hud) {
+    const float x = SCREEN_WIDTH - 270, y = 40;
+    const int rowHeight = 12;
+    al_draw_filled_rectangle(x - 10, y - 10, SCREEN_WIDTH - 10,
+        y + (Profiler::PHASE_COUNT + 4) * rowHeight + 10, al_map_rgba(0, 0, 0, 180));
+
+    ALLEGRO_COLOR color = al_map_rgb(0, 255, 0);
+    al_draw_text(font, color, x, y, 0, "phase       min    avg    p99 ms");
+    for (int p = 0; p < Profiler::PHASE_COUNT; p++) {
+        Profiler::PhaseStats stats = profiler.getStats((Profiler::Phase)p);
+        al_draw_textf(font, color, x, y + (p + 1) * rowHeight, 0, "%-8s %6.2f %6.2f %6.2f",
+            Profiler::phaseName((Profiler::Phase)p), stats.min, stats.avg, stats.p99);
+    }
+    FramePacer::Counters pacing = pacer.getCounters();
+    al_draw_textf(font, color, x, y + (Profiler::PHASE_COUNT + 1) * rowHeight, 0,
+        "catch-up ticks: %llu  skipped: %llu", pacing.catchUpTicks, pacing.skippedTicks);
+    al_draw_textf(font, color, x, y + (Profiler::PHASE_COUNT + 2) * rowHeight, 0,
+        "late frames: %llu / %llu", pacing.lateFrames, pacing.frames);
+    const HudLayer::Counters& renders = hud.getCounters();
+    al_draw_textf(font, color, x, y + (Profiler::PHASE_COUNT + 3) * rowHeight, 0,
+        "hud renders s/l/c: %lu/%lu/%lu", renders.renders[HudLayer::SCORE],
+        renders.renders[HudLayer::LEVEL], renders.renders[HudLayer::COINS]);
+}
+
+void Alma(const GameOptions& options) {
+    // Create game objects
+    Bike bike;
+    Player player(SCREEN_WIDTH / 2 - bike.getWidth() / 2,
+        SCREEN_HEIGHT - bike.getHeight() - 20,
+        SCREEN_HEIGHT);
+    // A replay brings its own seed and settings and takes over the input;
+    // a normal session records itself when --record names a file
+    ReplayReader playback;
+    ReplayWriter recorder;
+    const bool watching = options.replayPath != nullptr;
+    if (watching && !playback.open(options.replayPath)) {
+        return;
+    }
+    HighwayConfig config;
+    config.tickRate = options.tickRate;
+    Highway highway(player, watching ? playback.getSeed() : options.seed,
+        watching ? playback.getConfig() : config);
+    Renderer renderer(bike);
+    HudLayer hud(font, 1.0 / options.hudScoreRate);
+    std::unique_ptr<Profiler> profiler(new Profiler()); // Too big for the stack
+    FramePacer pacer(options.maxCatchUp);
+    SoundEffects effects;
+    SimulationThread simulation(player, highway, *profiler, pacer);
+    const int tickRate = highway.getConfig().tickRate;
+
+    if (watching) {
+        if (!playback.seek(highway, player, options.seekTick)) {
+            std::cerr << "Replay has no keyframe to start from: " << options.replayPath << "\n";
+            return;
+        }
+        simulation.setPlayback(&playback);
+    }
+    else if (options.recordPath) {
+        // Rewinding takes ticks back out of the recording too
+        recorder.setRewindWindow(simulation.getRewindTicks());
+        if (recorder.open(options.recordPath, options.seed, highway)) {
+            simulation.setRecorder(&recorder);
+        }
+    }
+    if (effects.init()) {
+        simulation.setSoundEffects(&effects);
+    }
+
+    // Game state variables
+    bool running = true;
+    bool paused = false;
+    bool showProfiler = false;
+    bool muted = false;
+
+    set_music_playing(true);
+
+    // Start ticking; from here on player and highway belong to the
+    // simulation thread and this loop only draws its snapshots
+    if (!simulation.start(timer)) {
+        return;
+    }
+    const WorldSnapshot* world = nullptr;
+
+    // Frames run at the display rate. Vsync normally blocks in the flip; a
+    // frame that returns much sooner means vsync is off, so the loop sleeps
+    // out the rest of the refresh interval instead of spinning.
+    int refreshRate = al_get_display_refresh_rate(display);
+    const double frameInterval = 1.0 / (refreshRate > 0 ? refreshRate : 60);
+
+    // Frames are copied out of the backbuffer before each flip and encoded
+    // on other threads. The capture keeps its starting size through resizes.
+    FrameCapture capture;
+    if (options.capturePath) {
+        capture.start(options.capturePath, FrameCapture::formatForPath(options.capturePath),
+            al_get_display_width(display), al_get_display_height(display),
+            refreshRate > 0 ? refreshRate : 60, options.captureEncoders, options.captureQueue);
+    }
+
+    // Everything the loop needs is allocated by now; debug builds check that
+    // no frame or tick touches the heap
+    unsigned long long allocations = allocation_count();
+    (void)allocations;
+
+    // Main game loop
+    while (running) {
+        // Handle every pending event, then draw one frame
+        ALLEGRO_EVENT event;
+        while (running && al_get_next_event(event_queue, &event)) {
+            switch (event.type) {
+            case ALLEGRO_EVENT_DISPLAY_CLOSE:
+                running = false;
+                break;
+
+            case ALLEGRO_EVENT_DISPLAY_RESIZE:
+                // Regenerate the sprite variants for the new on-screen size. This is
+                // a load step, so the allocation check restarts from here.
+                al_acknowledge_resize(event.display.source);
+                renderer.resize(al_get_display_width(event.display.source),
+                    al_get_display_height(event.display.source));
+                allocations = allocation_count();
+                break;
+
+            case ALLEGRO_EVENT_DISPLAY_FOUND:
+                // The device was reset (e.g. a resolution switch); rebuild the sprites
+                renderer.reloadSprites();
+                hud.invalidate();
+                allocations = allocation_count();
+                break;
+
+            case ALLEGRO_EVENT_KEY_DOWN:
+                switch (event.keyboard.keycode) {
+                case ALLEGRO_KEY_ESCAPE:
+                    running = false;
+                    break;
+                case ALLEGRO_KEY_LEFT:
+                    simulation.setSteering(-1); // Move left
+                    break;
+                case ALLEGRO_KEY_RIGHT:
+                    simulation.setSteering(1);  // Move right
+                    break;
+                case ALLEGRO_KEY_BACKSPACE:
+                    simulation.setRewinding(true); // Rewind while held
+                    break;
+                case ALLEGRO_KEY_F3:
+                    showProfiler = !showProfiler; // Toggle the profiler overlay
+                    break;
+                case ALLEGRO_KEY_P:
+                    paused = !paused;     // Toggle pause
+                    simulation.setPaused(paused);
+
+                    // Pause/resume music when game is paused/resumed
+                    set_music_playing(!paused && !muted);
+                    break;
+                case ALLEGRO_KEY_M:
+                    // Toggle mute/unmute
+                    muted = !muted;
+                    set_music_playing(!paused && !muted);
+                    effects.setMuted(muted);
+                    break;
+                }
+                break;
+
+            case ALLEGRO_EVENT_KEY_UP:
+                switch (event.keyboard.keycode) {
+                case ALLEGRO_KEY_LEFT:
+                case ALLEGRO_KEY_RIGHT:
+                    simulation.setSteering(0);  // Stop horizontal movement
+                    break;
+                case ALLEGRO_KEY_BACKSPACE:
+                    simulation.setRewinding(false);
+                    break;
+                }
+                break;
+            }
+        }
+        if (!running) break;
+
+        // Start the effects the simulation triggered since the last frame
+        effects.update();
+
+        // Draw the newest tick, blended from the previous one by how far
+        // real time has moved past it. This shows the world up to one tick
+        // late but moves it smoothly at any display rate.
+        double frameStart = al_get_time();
+        simulation.acquire();
+        world = &simulation.latest();
+        if (world->isGameOver) {
+            break;
+        }
+        float alpha = (float)((frameStart - world->time) * tickRate);
+        if (alpha < 0) alpha = 0;
+        if (alpha > 1) alpha = 1;
+
+        // Clear screen and draw game elements
+        {
+            ProfileScope scope(*profiler, Profiler::DRAW);
+            al_clear_to_color(al_map_rgb(0, 0, 0));
+            renderer.draw(*world, alpha);
+        }
+
+        // Draw HUD
+        {
+            ProfileScope scope(*profiler, Profiler::HUD);
+            drawHud(hud, *world, paused, frameStart);
+            if (showProfiler) drawProfilerOverlay(*profiler, pacer, hud);
+        }
+
+        // Capture what is about to be shown; a frame the encoders have no
+        // room for is dropped so the game never waits on the disk
+        if (capture.isRunning()) {
+            ProfileScope scope(*profiler, Profiler::CAPTURE);
+            capture.captureFrom(al_get_backbuffer(display));
+        }
+
+        // Flip display
+        {
+            ProfileScope scope(*profiler, Profiler::FLIP);
+            al_flip_display();
+        }
+        profiler->endFrame();
+
+        if (profiler->getFrameCount() == 1) {
+            std::chrono::duration<double, std::milli> startup = std::chrono::steady_clock::now() - launch_time;
+            std::cout << "First frame after " << startup.count() << " ms\n";
+        }
+
+        double frameTime = al_get_time() - frameStart;
+        pacer.frameDone(frameTime, frameInterval);
+        if (frameTime < frameInterval / 2) {
+            al_rest(frameInterval - frameTime);
+        }
+
+        assert(allocation_count() == allocations && "heap allocation inside the game loop");
+    }
+
+    simulation.stop();
+    if (capture.isRunning()) {
+        capture.stop();
+        capture.printStats();
+    }
+    if (recorder.isOpen()) {
+        recorder.close(highway);
+        std::cout << "Replay saved to " << options.recordPath << " (tick "
+            << highway.getTick() << ")\n";
+    }
+    renderer.printStats();
+    hud.printStats();
+    pacer.printStats();
+    if (options.profileOut && profiler->writeCsv(options.profileOut)) {
+        std::cout << "Frame profile written to " << options.profileOut << "\n";
+    }
+
+    // Stop the music when game is over; the crash still plays
+    set_music_playing(false);
+    effects.update();
+    effects.printStats();
+
+    // Game over screen
+    if (world && world->isGameOver) {
+        al_clear_to_color(al_map_rgb(0, 0, 0));
+        al_draw_text(font, al_map_rgb(255, 0, 0), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 50,
+            ALLEGRO_ALIGN_CENTER, "GAME OVER");
+        al_draw_textf(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20,
+            ALLEGRO_ALIGN_CENTER, "Final Score: %d", world->score);
+        al_draw_textf(font, al_map_rgb(255, 255, 255), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 10,
+            ALLEGRO_ALIGN_CENTER, "Level Reached: %d", world->level);
+        al_draw_textf(font, al_map_rgb(255, 215, 0), SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 40,
+            ALLEGRO_ALIGN_CENTER, "Coins Collected: %d", world->coinCollected);
+        al_flip_display();
+        al_rest(3.0); // Show game over screen for 3 seconds
+    }
+}
+
+void cleanup_game() {
+    // Release cached sprites while the display still exists
+    SpriteCache::instance().printStats();
+    SpriteCache::instance().clear();
+
+    // Clean up game-specific resources
+    if (font) {
+        al_destroy_font(font);
+    }
+
+    // Clean up audio resources
+    if (game_music) {
+        al_destroy_audio_stream(game_music);
+    }
+}
+
+void cleanup_allegro() {
+    // Stop the loader threads and free anything they decoded that was never used
+    AssetLoader::instance().stop();
+
+    // Clean up Allegro resources
+    if (timer) {
+        al_destroy_timer(timer);
+    }
+    if (event_queue) {
+        al_destroy_event_queue(event_queue);
+    }
+    if (display) {
+        al_destroy_display(display);
+    }
+
+    // Uninstall audio
+    al_uninstall_audio();
+}
+
+int capture_replay(const GameOptions& options) {
+    // Drawing needs Allegro but no display: every bitmap, sprites included,
+    // is a memory bitmap drawn by the software renderer
+    if (!al_init() || !al_init_image_addon() || !al_init_font_addon() ||
+        !al_init_primitives_addon()) {
+        std::cerr << "Failed to initialize Allegro for capture!\n";
+        return 1;
+    }
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR);
+    use_sprite_pack();
+    font = al_create_builtin_font();
+    if (!font) {
+        std::cerr << "Failed to create built-in font!\n";
+        return 1;
+    }
+
+    int result = 1;
+    {
+        ReplayReader playback;
+        if (!playback.open(options.replayPath)) {
+            cleanup_game();
+            return 1;
+        }
+        Bike bike;
+        Player player(SCREEN_WIDTH / 2 - bike.getWidth() / 2,
+            SCREEN_HEIGHT - bike.getHeight() - 20,
+            SCREEN_HEIGHT);
+        Highway highway(player, playback.getSeed(), playback.getConfig());
+        Renderer renderer(bike);
+        HudLayer hud(font, 1.0 / options.hudScoreRate);
+        WorldSnapshot world;
+        const int tickRate = highway.getConfig().tickRate;
+
+        if (!playback.seek(highway, player, options.seekTick)) {
+            std::cerr << "Replay has no keyframe to start from: " << options.replayPath << "\n";
+        }
+        else {
+            // One frame per tick, so the video plays at the recorded speed
+            FrameCapture capture;
+            if (capture.start(options.capturePath, FrameCapture::formatForPath(options.capturePath),
+                SCREEN_WIDTH, SCREEN_HEIGHT, tickRate, options.captureEncoders, options.captureQueue)) {
+                auto start = std::chrono::steady_clock::now();
+                int previousLevel = highway.getLevel();
+                int levelUpTicks = 0;
+                world.reserve(highway);
+                while (highway.getTick() < playback.getEndTick() && !highway.isGameOver) {
+                    world.capturePrevious(highway);
+                    playback.playTo(highway, player, highway.getTick() + 1);
+
+                    // Same banner timing as the simulation thread
+                    if (highway.getLevel() > previousLevel) {
+                        levelUpTicks = (int)(180 / highway.getStepScale());
+                        previousLevel = highway.getLevel();
+                    }
+                    if (levelUpTicks > 0) {
+                        levelUpTicks--;
+                    }
+                    world.capture(highway);
+                    world.levelUpTicks = levelUpTicks;
+
+                    // Frames come off the tick, not the clock, so every one is
+                    // drawn fully advanced and the HUD times against game time
+                    ALLEGRO_BITMAP* frame = capture.acquire(true);
+                    ALLEGRO_STATE state;
+                    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_TRANSFORM);
+                    al_set_target_bitmap(frame);
+                    al_clear_to_color(al_map_rgb(0, 0, 0));
+                    renderer.draw(world, 1.0f);
+                    drawHud(hud, world, false, (double)highway.getTick() / tickRate);
+                    al_restore_state(&state);
+                    capture.submit(frame);
+                }
+                capture.stop();
+
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                FrameCapture::Counters counters = capture.getCounters();
+                std::cout << "Rendered " << counters.submitted << " frames in " << seconds << " s ("
+                    << (seconds > 0 ? counters.submitted / seconds : 0.0) << " frames/s)\n";
+                capture.printStats();
+                renderer.printStats();
+                result = counters.failed == 0 ? 0 : 1;
+            }
+        }
+    }
+
+    cleanup_game();
+    return result;
 }
\ No newline at end of file
@@ -1,32 +1,48 @@
-#ifndef GAME_H
-#define GAME_H
-
-#include <allegro5/allegro.h>
-#include <allegro5/allegro_image.h>
-#include <allegro5/allegro_font.h>
-#include <allegro5/allegro_ttf.h>
-#include <allegro5/allegro_primitives.h>
-#include <allegro5/allegro_audio.h>
-#include <allegro5/allegro_acodec.h>
-#include <iostream>
-
-// Screen dimensions and frame rate
-constexpr int SCREEN_WIDTH = 1000;
-constexpr int SCREEN_HEIGHT = 800;
-constexpr int FPS = 80;
-
-// Global Allegro objects
-extern ALLEGRO_DISPLAY* display;
-extern ALLEGRO_EVENT_QUEUE* event_queue;
-extern ALLEGRO_TIMER* timer;
-extern ALLEGRO_FONT* font;
-extern ALLEGRO_SAMPLE* game_sound;
-extern ALLEGRO_SAMPLE_INSTANCE* game_sound_instance;
-
-bool initialize_allegro();
-bool initialize_game();
-void Alma();
-void cleanup_game();
-void cleanup_allegro();
-
+#ifndef GAME_H
+#define GAME_H
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_image.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_primitives.h>
+#include <allegro5/allegro_audio.h>
+#include <allegro5/allegro_acodec.h>
+#include <cstdint>
+#include <iostream>
+#include "constants.h"
+#include "framepacer.h"
+
+// Global Allegro objects
+extern ALLEGRO_DISPLAY* display;
+extern ALLEGRO_EVENT_QUEUE* event_queue;
+extern ALLEGRO_TIMER* timer;
+extern ALLEGRO_FONT* font;
+extern ALLEGRO_AUDIO_STREAM* game_music;
+
+// Command-line settings for a windowed game session
+struct GameOptions {
+    uint64_t seed = 0;
+    const char* profileOut = nullptr; // CSV file for the per-frame profile, written on exit
+    int tickRate = FPS; // Logic ticks per second; rendering follows the display
+    int maxCatchUp = FramePacer::DEFAULT_MAX_CATCH_UP; // Most overdue ticks simulated back to back after a stall
+    int hudScoreRate = 10; // Most score redraws per second
+    const char* recordPath = nullptr; // Replay of the session, --record FILE
+    const char* replayPath = nullptr; // Watch this replay instead of playing
+    unsigned long long seekTick = 0;  // Tick the replay starts from
+    const char* capturePath = nullptr; // Save every frame: a directory for PNGs or a .y4m file
+    int captureEncoders = 0; // Encoder threads, 0 for a default
+    int captureQueue = 0;    // Frames that can wait for an encoder, 0 for a default
+};
+
+bool initialize_allegro();
+bool initialize_game();
+void Alma(const GameOptions& options);
+void cleanup_game();
+void cleanup_allegro();
+
+// Renders options.replayPath from options.seekTick to the end into
+// options.capturePath, one frame per tick, without a display or audio.
+// Rendering waits for the encoders rather than dropping frames.
+int capture_replay(const GameOptions& options);
+
 #endif // GAME_H
\ No newline at end of file
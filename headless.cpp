@@ -0,0 +1,97 @@
+#include "headless.h"
+#include "alloccounter.h"
+#include "constants.h"
+#include "environment.h"
+#include "highway.h"
+#include "replay.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+int run_headless(unsigned long long ticks, uint64_t seed) {
+    Player player(0, 0, SCREEN_HEIGHT);
+    player.reset();
+    Highway highway(player, seed);
+
+    unsigned long long episodes = 0;
+    long long totalScore = 0;
+
+    // Restarts included, stepping must never touch the heap
+    unsigned long long allocations = allocation_count();
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long tick = 0; tick < ticks; tick++) {
+        // Sweep across the lanes so collisions and coin pickups get exercised
+        player.steer((tick / 120) % 2 == 0 ? 1 : -1, highway.getStepScale());
+
+        player.update();
+        highway.update();
+        highway.checkCollisions();
+
+        if (highway.isGameOver) {
+            episodes++;
+            totalScore += highway.getScore();
+            player.reset();
+            highway.reset(seed + episodes);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    assert(allocation_count() == allocations && "heap allocation while stepping the simulation");
+    (void)allocations;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Headless run: " << ticks << " ticks in " << seconds << " s ("
+        << (seconds > 0 ? ticks / seconds : 0.0) << " ticks/s)\n";
+    std::cout << "Episodes finished: " << episodes;
+    if (episodes > 0) {
+        std::cout << ", average score: " << totalScore / (long long)episodes;
+    }
+    std::cout << "\n";
+    std::cout << "Seed: " << seed << ", final state hash: " << std::hex
+        << highway.stateHash() << std::dec << "\n";
+
+    return 0;
+}
+
+int run_replay(const char* path, unsigned long long seekTick) {
+    ReplayReader replay;
+    if (!replay.open(path)) {
+        return 1;
+    }
+
+    Player player(0, 0, SCREEN_HEIGHT);
+    player.reset();
+    Highway highway(player, replay.getSeed(), replay.getConfig());
+
+    auto start = std::chrono::steady_clock::now();
+    if (!replay.seek(highway, player, seekTick)) {
+        std::cerr << "Replay has no keyframe to start from: " << path << "\n";
+        return 1;
+    }
+    auto seeked = std::chrono::steady_clock::now();
+    unsigned long long from = highway.getTick();
+    replay.playTo(highway, player, replay.getEndTick());
+    auto end = std::chrono::steady_clock::now();
+
+    double seekSeconds = std::chrono::duration<double>(seeked - start).count();
+    double playSeconds = std::chrono::duration<double>(end - seeked).count();
+    unsigned long long played = highway.getTick() - from;
+    std::cout << "Replay: " << replay.getKeyframeCount() << " keyframes, seed "
+        << replay.getSeed() << ", ticks 0-" << replay.getEndTick() << "\n";
+    std::cout << "Seek to tick " << from << " in " << seekSeconds * 1000 << " ms, played "
+        << played << " ticks in " << playSeconds << " s ("
+        << (playSeconds > 0 ? played / playSeconds : 0.0) << " ticks/s)\n";
+    std::cout << "Final state hash: " << std::hex << highway.stateHash() << std::dec << "\n";
+
+    if (!replay.isComplete()) {
+        std::cout << "Replay is truncated; nothing to verify against\n";
+        return 0;
+    }
+    if (highway.stateHash() != replay.getFinalHash()) {
+        std::cerr << "Replay diverged: recorded hash " << std::hex << replay.getFinalHash()
+            << std::dec << "\n";
+        return 1;
+    }
+    std::cout << "Replay reproduced the recorded final state\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <cstdint>
+
+// Steps the simulation as fast as the CPU allows without creating a display
+// or touching Allegro. Starts a new episode (seeded seed + episode number)
+// whenever the player crashes and prints throughput statistics and the final
+// state hash, which is identical for identical seeds.
+int run_headless(unsigned long long ticks, uint64_t seed);
+
+// Seeks a recorded replay to seekTick, plays it to the end as fast as
+// possible and checks the final state hash against the recorded one.
+// Returns nonzero if the replay cannot be read or does not reproduce.
+int run_replay(const char* path, unsigned long long seekTick);
+
+#endif // HEADLESS_H
\ No newline at end of file
@@ -1,246 +1,575 @@
-#include "highway.h"
-#include "game.h"
-#include "bike.h"
-#include "environment.h"
-#include "coin.h"
-#include <allegro5/allegro_primitives.h>
-#include <cstdlib>
-#include <ctime>
-#include <iostream>
-
-const char* Obstacle::CAR_IMAGES[3] = {
-    "assets/car1.png",
-    "assets/car2.png",
-    "assets/car3.png"
-};
-
-Obstacle::Obstacle(float start_x, float start_y, float speed)
-    : x(start_x), y(start_y), speed(speed), image(nullptr) {
-    int carType = rand() % 3;
-    image = al_load_bitmap(CAR_IMAGES[carType]);
-
-    if (!image) {
-        std::cerr << "Failed to load car image: " << CAR_IMAGES[carType] << "\n";
-        image = al_create_bitmap(WIDTH, HEIGHT);
-        al_set_target_bitmap(image);
-        al_clear_to_color(al_map_rgb(255, 0, 0));
-        al_set_target_backbuffer(al_get_current_display());
-    }
-}
-
-Obstacle::~Obstacle() {
-    if (image) al_destroy_bitmap(image);
-}
-
-void Obstacle::update() {
-    y += speed;
-    if (y > SCREEN_HEIGHT) {
-        y = -HEIGHT;
-        x = LANE_POSITIONS[rand() % LANE_COUNT] + (LANE_WIDTH - WIDTH) / 2;
-        speed += 0.05f;
-
-        int carType = rand() % 3;
-        ALLEGRO_BITMAP* new_img = al_load_bitmap(CAR_IMAGES[carType]);
-        if (new_img) {
-            if (image) al_destroy_bitmap(image);
-            image = new_img;
-        }
-    }
-}
-
-void Obstacle::draw() {
-    if (image) {
-        al_draw_scaled_bitmap(image,
-            0, 0, al_get_bitmap_width(image), al_get_bitmap_height(image),
-            x, y, WIDTH, HEIGHT, 0);
-    }
-    else {
-        al_draw_filled_rectangle(x, y, x + WIDTH, y + HEIGHT, al_map_rgb(255, 0, 0));
-    }
-}
-
-bool Obstacle::checkCollision(const Player& player) const {
-    // Obstacle collision box
-    float obsLeft = getCollisionX();
-    float obsRight = obsLeft + getCollisionWidth();
-    float obsTop = getCollisionY();
-    float obsBottom = obsTop + getCollisionHeight();
-
-    // Player collision box
-    float playerLeft = player.x + player.collisionOffsetX;
-    float playerRight = playerLeft + player.frameWidth - 2 * player.collisionOffsetX;
-    float playerTop = player.y + player.collisionOffsetY;
-    float playerBottom = playerTop + player.frameHeight - 2 * player.collisionOffsetY;
-
-    // Check for overlap
-    return obsLeft < playerRight &&
-        obsRight > playerLeft &&
-        obsTop < playerBottom &&
-        obsBottom > playerTop;
-}
-
-Highway::Highway(Bike& bike, Player& player)
-    : playerBike(bike), player(player), score(0), coinCollected(0), isGameOver(false),
-    background(nullptr), backgroundY(0), currentLevel(1), baseSpeed(3.0f), scrollSpeed(2.0f) {
-    std::srand(static_cast<unsigned>(time(nullptr)));
-    loadBackground();
-    generateObstacles();
-    spawnCoins();
-}
-
-void Highway::loadBackground() {
-    if (background) al_destroy_bitmap(background);
-    background = al_load_bitmap("assets/background.png");
-
-    if (!background) {
-        std::cerr << "Failed to load background - using fallback\n";
-        background = al_create_bitmap(SCREEN_WIDTH, SCREEN_HEIGHT);
-        al_set_target_bitmap(background);
-        al_clear_to_color(al_map_rgb(50, 50, 150));
-
-        for (int i = 0; i <= LANE_COUNT; i++) {
-            al_draw_line(FIRST_LANE_X + i * LANE_WIDTH, 0,
-                FIRST_LANE_X + i * LANE_WIDTH, SCREEN_HEIGHT,
-                al_map_rgb(255, 255, 255), 2);
-        }
-
-        al_set_target_backbuffer(al_get_current_display());
-    }
-    else {
-        ALLEGRO_BITMAP* stretched = al_create_bitmap(SCREEN_WIDTH, SCREEN_HEIGHT);
-        al_set_target_bitmap(stretched);
-        al_draw_scaled_bitmap(
-            background,
-            0, 0, al_get_bitmap_width(background), al_get_bitmap_height(background),
-            0, 0, SCREEN_WIDTH, SCREEN_HEIGHT,
-            0
-        );
-        al_destroy_bitmap(background);
-        background = stretched;
-        al_set_target_backbuffer(al_get_current_display());
-    }
-}
-
-void Highway::generateObstacles() {
-    gameObjects.clear();
-    int obstacleCount = 5;
-    for (int i = 0; i < obstacleCount; i++) {
-        int lane = rand() % LANE_COUNT;
-        float x = LANE_POSITIONS[lane] + (LANE_WIDTH - Obstacle::WIDTH) / 2;
-        float y = -Obstacle::HEIGHT - (rand() % SCREEN_HEIGHT);
-        float speed = baseSpeed + (rand() % 3);
-        gameObjects.emplace_back(std::make_unique<Obstacle>(x, y, speed));
-    }
-}
-
-void Highway::spawnCoins() {
-    coins.clear();
-    int coinCount = 3;
-
-    for (int i = 0; i < coinCount; i++) {
-        int lane = rand() % LANE_COUNT;
-        float x = LANE_POSITIONS[lane] + (LANE_WIDTH - Coin::WIDTH) / 2;
-        float y = -Coin::HEIGHT - (rand() % SCREEN_HEIGHT);
-        coins.emplace_back(std::make_unique<Coin>(x, y));
-    }
-}
-
-void Highway::update() {
-    backgroundY += scrollSpeed;
-    if (backgroundY >= SCREEN_HEIGHT) {
-        backgroundY = 0;
-    }
-
-    // Update obstacles
-    for (auto& obj : gameObjects) {
-        obj->update();
-    }
-
-    // Update coins
-    for (auto& coin : coins) {
-        coin->update();
-    }
-
-    score++;
-}
-
-void Highway::draw() {
-    // Draw the background
-    if (background) {
-        // Draw the background twice for scrolling effect
-        al_draw_bitmap(background, 0, backgroundY - SCREEN_HEIGHT, 0);
-        al_draw_bitmap(background, 0, backgroundY, 0);
-    }
-
-    // Draw obstacles
-    for (auto& obj : gameObjects) {
-        obj->draw();
-    }
-
-    // Draw coins
-    for (auto& coin : coins) {
-        coin->draw();
-    }
-
-    // Draw player
-    playerBike.draw(player.x, player.y);
-}
-
-void Highway::checkCollisions() {
-    // Check for collision with obstacles
-    for (auto& obj : gameObjects) {
-        auto* obstacle = dynamic_cast<Obstacle*>(obj.get());
-        if (obstacle && obstacle->checkCollision(player)) {
-            isGameOver = true;
-            return;
-        }
-    }
-
-    // Check for collision with coins
-    for (auto& coinObj : coins) {
-        auto* coin = dynamic_cast<Coin*>(coinObj.get());
-        if (coin && !coin->isCollected() && coin->checkCollision(player)) {
-            coin->collect();
-            coinCollected++;
-            score += 100;  // Add 100 points for collecting a coin
-
-            // Check if player has collected enough coins to level up
-            checkLevelProgress();
-        }
-    }
-}
-
-void Highway::checkLevelProgress() {
-    // Check if player has collected enough coins to level up
-    if (coinCollected >= COINS_FOR_LEVEL_UP * currentLevel && currentLevel < MAX_LEVEL) {
-        increaseLevel();
-    }
-}
-
-void Highway::increaseLevel() {
-    // Increase level
-    currentLevel++;
-
-    // Increase base speed by 25%
-    baseSpeed *= 1.25f;
-    scrollSpeed *= 1.25f;
-
-    // Apply new speed to existing obstacles
-    for (auto& obj : gameObjects) {
-        auto* obstacle = dynamic_cast<Obstacle*>(obj.get());
-        if (obstacle) {
-            obstacle->speed *= 1.25f;
-        }
-    }
-
-    // Apply new speed to coins as well
-    for (auto& coinObj : coins) {
-        auto* coin = dynamic_cast<Coin*>(coinObj.get());
-        if (coin) {
-            coin->setSpeed(coin->getSpeed() * 1.25f);
-        }
-    }
-
-    // Add bonus points for leveling up
-    score += 500 * currentLevel;
+#include "highway.h"
+#include "bytestream.h"
+#include "constants.h"
+#include "environment.h"
+#include "coin.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+bool Obstacle::checkCollision(float x, float y, const Player& player) {
+    // Obstacle collision box
+    float obsLeft = x + collisionOffsetX;
+    float obsRight = obsLeft + getCollisionWidth();
+    float obsTop = y + collisionOffsetY;
+    float obsBottom = obsTop + getCollisionHeight();
+
+    // Player collision box
+    float playerLeft = player.x + player.collisionOffsetX;
+    float playerRight = playerLeft + player.frameWidth - 2 * player.collisionOffsetX;
+    float playerTop = player.y + player.collisionOffsetY;
+    float playerBottom = playerTop + player.frameHeight - 2 * player.collisionOffsetY;
+
+    // Check for overlap
+    return obsLeft < playerRight &&
+        obsRight > playerLeft &&
+        obsTop < playerBottom &&
+        obsBottom > playerTop;
+}
+
+void ObstacleArray::reserve(size_t capacity) {
+    x.reserve(capacity);
+    y.reserve(capacity);
+    speed.reserve(capacity);
+    carType.reserve(capacity);
+    parked.reserve(capacity);
+}
+
+void ObstacleArray::clear() {
+    x.clear();
+    y.clear();
+    speed.clear();
+    carType.clear();
+    parked.clear();
+}
+
+void ObstacleArray::add(float startX, float startY, float startSpeed, int type) {
+    assert(size() < x.capacity() && "obstacle pool is full");
+    x.push_back(startX);
+    y.push_back(startY);
+    speed.push_back(startSpeed);
+    carType.push_back(type);
+    if (startSpeed == 0) {
+        parked.push((uint32_t)(size() - 1));
+    }
+}
+
+void ObstacleArray::update(float step) {
+    const size_t count = size();
+    for (size_t i = 0; i < count; i++) {
+        if (y[i] > SCREEN_HEIGHT && speed[i] != 0) {
+            y[i] = PARKED_Y;
+            speed[i] = 0;
+            parked.push((uint32_t)i);
+        }
+        y[i] += speed[i] * step;
+    }
+}
+
+void ObstacleArray::parkAll() {
+    std::fill(x.begin(), x.end(), 0.0f);
+    std::fill(y.begin(), y.end(), PARKED_Y);
+    std::fill(speed.begin(), speed.end(), 0.0f);
+    std::fill(carType.begin(), carType.end(), 0);
+    parked.parkAll(size());
+}
+
+void ObstacleArray::collectParked() {
+    parked.collect(speed.data(), size());
+}
+
+int ObstacleArray::place(float newX, float newY, float newSpeed, int type) {
+    if (parked.empty()) return -1;
+    const uint32_t i = parked.takeLowest();
+
+    x[i] = newX;
+    y[i] = newY;
+    speed[i] = newSpeed;
+    carType[i] = type;
+    return (int)i;
+}
+
+Highway::Highway(Player& player, uint64_t seed, const HighwayConfig& config)
+    : config(config), player(player), stepScale((float)FPS / config.tickRate) {
+    // Size every pool and scratch buffer for the largest case up front
+    const size_t maxEntities = std::max(config.obstacleCount, config.coinCount);
+    obstacles.reserve(config.obstacleCount);
+    coins.reserve(config.coinCount);
+    for (int i = 0; i < config.obstacleCount; i++) {
+        obstacles.add(0, PARKED_Y, 0, 0);
+    }
+    for (int i = 0; i < config.coinCount; i++) {
+        coins.add(0, PARKED_Y, 0);
+    }
+    obstacleIndex.reserve(config.obstacleCount);
+    coinIndex.reserve(config.coinCount);
+    hitMask.resize(hitMaskWords(maxEntities));
+    candidates.reserve(maxEntities);
+    candidateX.reserve(maxEntities);
+    candidateY.reserve(maxEntities);
+    candidateSpeed.reserve(maxEntities);
+    impact.resize(maxEntities);
+
+    reset(seed);
+}
+
+void Highway::reset(uint64_t seed) {
+    isGameOver = false;
+    score = 0;
+    coinCollected = 0;
+    currentLevel = 1;
+    tick = 0;
+    backgroundY = 0;
+    worldScale = levelSpeedScale(currentLevel);
+    lastStep = 0;
+    sweepFrom = playerCollisionBox(player); // The player is reset first
+    scoreCarry = 0;
+    rng.reseed(seed);
+
+    generateObstacles();
+}
+
+// Level 1 speeds: the road and coins, and the first row of cars
+static const float SCROLL_SPEED = 2.0f;
+static const float BASE_SPEED = 3.0f;
+
+// Broadphase indices keep cars and coins until they are parked, including
+// the tick they spend below the screen (only something covering a whole
+// screen in one tick could get past this before being parked)
+static const float INDEXED_MAX_Y = PARKED_Y - 1;
+
+// Smallest rowSpacing override; much closer and lastRowY would stop moving
+// between rows
+static const float MIN_ROW_SPACING = 1.0f / 128;
+
+// Traffic speeds up by this much per pixel of rows laid out, so it gets
+// faster at the same pace whatever the density
+static const float SPEED_CREEP = 0.05f / (SCREEN_HEIGHT + Obstacle::HEIGHT);
+
+void Highway::generateObstacles() {
+    // Every car and coin waits in the pool; the road starts empty with a
+    // screen's worth of traffic already queued above it
+    obstacles.parkAll();
+    coins.parkAll();
+    parkedStale = false;
+    obstacleIndex.clear();
+    coinIndex.clear();
+
+    traffic.reset();
+    trafficSpeed = BASE_SPEED + 1;
+    lastRowSpeed = trafficSpeed;
+    lastRowY = -Obstacle::HEIGHT + nextRowSpacing(); // First row lands at the top
+    spawnRows(-Obstacle::HEIGHT - SCREEN_HEIGHT, false);
+}
+
+float Highway::rowSpacing() const {
+    if (config.rowSpacing > 0) return std::max(config.rowSpacing, MIN_ROW_SPACING);
+    return level_params(currentLevel).rowSpacing;
+}
+
+float Highway::nextRowSpacing() {
+    // The next chunk is picked as soon as the last one is used up, so the
+    // row that opens it leaves just the room needed to reach its free lane
+    if (traffic.atChunkEnd()) {
+        traffic.startChunk(rng, level_params(currentLevel).trafficTier);
+    }
+    float spacing = rowSpacing();
+    if (traffic.atChunkStart() && spacing >= Obstacle::HEIGHT) {
+        spacing += laneChangeDistance(traffic.lanesToCross());
+    }
+    return spacing;
+}
+
+float Highway::laneChangeDistance(int lanes) const {
+    // Crossing that many lanes, in FPS-rate ticks, with room for a level-up
+    // speeding traffic up while the gap is on the road
+    const float crossingTicks = lanes * LANE_WIDTH / Player::STEER_SPEED;
+    return crossingTicks * trafficSpeed * levelSpeedScale(currentLevel + 1);
+}
+
+float Highway::levelSpeedScale(int level) const {
+    if (config.levelSpeedMultiplier > 0) {
+        int steps = std::min(std::max(level, 1), LEVEL_COUNT) - 1;
+        return std::pow(config.levelSpeedMultiplier, (float)steps);
+    }
+    return level_params(level).speedScale;
+}
+
+void Highway::spawnRows(float topY, bool entering) {
+    // The next row follows the last at the row spacing, plus room to switch
+    // to another free lane when it opens a new chunk
+    for (;;) {
+        float spacing = nextRowSpacing();
+        float y = lastRowY - spacing;
+        if (y < topY) break;
+
+        // A row entering mid-tick has been on the road since it crossed
+        // topY, moving at its own speed; placing it as of that moment keeps
+        // the layout the same at every tick rate
+        float late = entering ? (y - topY) / lastRowSpeed : 0;
+        spawnRow(traffic.next(), entering ? topY : y, late);
+        trafficSpeed += SPEED_CREEP * spacing; // Traffic keeps getting a little faster
+    }
+}
+
+void Highway::spawnRow(const PatternRow& row, float y, float late) {
+    const float carY = y + trafficSpeed * late;
+    // A row that finds the pool empty spawns short; fewer cars never block
+    // the free lane
+    const bool indexCars = obstacles.size() >= LaneIndex::MIN_ENTITIES;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        if (!((row.cars >> lane) & 1)) continue;
+        if (!obstacles.hasParked()) break;
+        int i = obstacles.place(LANE_POSITIONS[lane] + (LANE_WIDTH - Obstacle::WIDTH) / 2, carY,
+            trafficSpeed, rng.nextInt(Obstacle::CAR_TYPES));
+        if (indexCars) obstacleIndex.insert(lane, carY, static_cast<uint32_t>(i));
+    }
+
+    if (row.coinLane >= 0) {
+        float coinY = y + (Obstacle::HEIGHT - Coin::HEIGHT) / 2 + SCROLL_SPEED * late;
+        int i = coins.place(LANE_POSITIONS[row.coinLane] + (LANE_WIDTH - Coin::WIDTH) / 2, coinY,
+            SCROLL_SPEED);
+        if (i >= 0 && coins.size() >= LaneIndex::MIN_ENTITIES) {
+            coinIndex.insert(row.coinLane, coinY, static_cast<uint32_t>(i));
+        }
+    }
+
+    lastRowY = carY;
+    lastRowSpeed = trafficSpeed;
+}
+
+void Highway::update() {
+    // Everything moves at its level 1 speed times the level's scale
+    const float step = stepScale * worldScale;
+    lastStep = step;
+    backgroundY += SCROLL_SPEED * step;
+    if (backgroundY >= SCREEN_HEIGHT) {
+        backgroundY = 0;
+    }
+
+    // Update obstacles and coins in one batch pass each, then let the next
+    // rows of traffic in. Small traffic is tested without the broadphase.
+    if (parkedStale) {
+        obstacles.collectParked();
+        coins.collectParked();
+        parkedStale = false;
+    }
+    obstacles.update(step);
+    coins.update(step);
+    lastRowY += lastRowSpeed * step;
+    if (obstacles.size() >= LaneIndex::MIN_ENTITIES) {
+        obstacleIndex.refresh(obstacles.y.data(), INDEXED_MAX_Y);
+    }
+    if (coins.size() >= LaneIndex::MIN_ENTITIES) {
+        coinIndex.refresh(coins.y.data(), INDEXED_MAX_Y);
+    }
+    spawnRows(-Obstacle::HEIGHT, true);
+
+    // One point per FPS-rate tick survived, whatever the tick rate
+    scoreCarry += stepScale;
+    int points = (int)scoreCarry;
+    score += points;
+    scoreCarry -= points;
+    tick++;
+}
+
+#ifndef NDEBUG
+// Debug builds check the broadphase + swept kernel against a full scalar
+// scan of the end positions: the sweep must catch at least those
+static size_t countScalarHits(const std::vector<float>& xs, const std::vector<float>& ys,
+    bool (*scalar)(float, float, const Player&), const Player& player) {
+    size_t hits = 0;
+    for (size_t i = 0; i < xs.size(); i++) {
+        if (scalar(xs[i], ys[i], player)) hits++;
+    }
+    return hits;
+}
+#endif
+
+size_t Highway::collideCandidates(const LaneIndex& index, const float* xs, const float* ys,
+    const float* speeds, size_t count, float maxSpeed, const EntityShape& shape,
+    const CollisionBox& from, const CollisionBox& to) {
+    // Few entities: test them all, candidates are simply 0..count-1
+    if (count < LaneIndex::MIN_ENTITIES) {
+        candidates.clear();
+        for (size_t i = 0; i < count; i++) {
+            candidates.push_back(static_cast<uint32_t>(i));
+        }
+        return collideSwept(xs, ys, speeds, lastStep, maxSpeed, count, shape, from, to,
+            hitMask.data(), impact.data());
+    }
+
+    // Only the lanes the player swept across, and only entities whose padded
+    // box can reach it vertically from where they ended the tick (window
+    // widened by a pixel; the narrowphase is exact). Nothing moves faster
+    // than maxSpeed, so nothing further down was anywhere near the player.
+    candidates.clear();
+    float top = std::min(from.top, to.top);
+    float bottom = std::max(from.bottom, to.bottom);
+    index.query(std::min(from.left, to.left), std::max(from.right, to.right),
+        top - shape.offsetY - shape.height - 1,
+        bottom - shape.offsetY + maxSpeed * lastStep + 1, candidates);
+
+    candidateX.clear();
+    candidateY.clear();
+    candidateSpeed.clear();
+    for (uint32_t i : candidates) {
+        candidateX.push_back(xs[i]);
+        candidateY.push_back(ys[i]);
+        candidateSpeed.push_back(speeds[i]);
+    }
+
+    size_t words = hitMaskWords(candidates.size());
+    if (hitMask.size() < words) hitMask.resize(words);
+    if (impact.size() < candidates.size()) impact.resize(candidates.size());
+    return collideSwept(candidateX.data(), candidateY.data(), candidateSpeed.data(), lastStep,
+        maxSpeed, candidates.size(), shape, from, to, hitMask.data(), impact.data());
+}
+
+void Highway::checkCollisions() {
+    // The player box is swept from where the previous tick left it to where
+    // it is now and tested against the broadphase candidates
+    const CollisionBox from = sweepFrom;
+    const CollisionBox to = playerCollisionBox(player);
+    sweepFrom = to;
+
+    // Check for collision with obstacles, keeping the earliest impact.
+    // trafficSpeed, the next row's speed, is above every car on the road.
+    size_t hits = collideCandidates(obstacleIndex, obstacles.x.data(), obstacles.y.data(),
+        obstacles.speed.data(), obstacles.size(), trafficSpeed,
+        Obstacle::getCollisionShape(), from, to);
+    assert(hits >= countScalarHits(obstacles.x, obstacles.y, Obstacle::checkCollision, player));
+    float crashTime = 2; // Later than any impact: no crash
+    if (hits > 0) {
+        isGameOver = true;
+        for (size_t k = 0; k < candidates.size(); k++) {
+            if ((hitMask[k / 32] >> (k % 32)) & 1u) crashTime = std::min(crashTime, impact[k]);
+        }
+    }
+
+    // Check for collision with coins; only those reached before the crash count
+    hits = collideCandidates(coinIndex, coins.x.data(), coins.y.data(), coins.speed.data(),
+        coins.size(), SCROLL_SPEED, Coin::getCollisionShape(), from, to);
+    assert(hits >= countScalarHits(coins.x, coins.y, Coin::checkCollision, player));
+    if (hits == 0) return;
+
+    for (size_t k = 0; k < candidates.size(); k++) {
+        uint32_t i = candidates[k];
+        bool hit = (hitMask[k / 32] >> (k % 32)) & 1u;
+        if (hit && impact[k] < crashTime && !coins.collected[i]) {
+            coins.collected[i] = 1;
+            coinCollected++;
+            score += 100;  // Add 100 points for collecting a coin
+
+            // Check if player has collected enough coins to level up
+            checkLevelProgress();
+        }
+    }
+}
+
+int Highway::getCoinTarget() const {
+    if (currentLevel >= LEVEL_COUNT) return 0;
+    if (config.coinsForLevelUp > 0) return config.coinsForLevelUp * currentLevel;
+    return level_params(currentLevel).coinTarget;
+}
+
+void Highway::checkLevelProgress() {
+    // Check if player has collected enough coins to level up
+    int target = getCoinTarget();
+    if (target > 0 && coinCollected >= target) {
+        increaseLevel();
+    }
+}
+
+void Highway::increaseLevel() {
+    // Increase level
+    currentLevel++;
+
+    // Speed the whole world up (by 25% in the shipped game); nothing stores
+    // a scaled speed, so this is the only thing to change
+    worldScale = levelSpeedScale(currentLevel);
+
+    // Add bonus points for leveling up
+    score += level_params(currentLevel).bonus;
+}
+
+// Snapshot layout: the scalar fields in a fixed order, then each entity
+// array prefixed by its element count
+static const size_t SNAPSHOT_CURSOR_OFFSET = 1 + 3 * sizeof(int) + sizeof(uint64_t) +
+    2 * sizeof(float) + 4 * sizeof(uint32_t) + 3 * sizeof(float);
+static const size_t SNAPSHOT_FIXED_BYTES = SNAPSHOT_CURSOR_OFFSET + 2 * sizeof(int32_t) + 2 +
+    4 * sizeof(float);
+static const size_t OBSTACLE_BYTES = 3 * sizeof(float) + sizeof(int);
+static const size_t COIN_BYTES = 3 * sizeof(float) + sizeof(uint8_t);
+
+size_t Highway::getSnapshotCapacity() const {
+    return SNAPSHOT_FIXED_BYTES + 2 * sizeof(uint32_t) +
+        obstacles.x.capacity() * OBSTACLE_BYTES + coins.x.capacity() * COIN_BYTES;
+}
+
+size_t Highway::saveSnapshot(uint8_t* out) const {
+    uint8_t* start = out;
+    uint32_t rngState[4];
+    rng.getState(rngState);
+
+    out = putValue(out, (uint8_t)isGameOver);
+    out = putValue(out, score);
+    out = putValue(out, coinCollected);
+    out = putValue(out, currentLevel);
+    out = putValue(out, (uint64_t)tick);
+    out = putValue(out, backgroundY);
+    out = putValue(out, scoreCarry);
+    for (uint32_t word : rngState) out = putValue(out, word);
+    const TrafficCursor& cursor = traffic.getCursor();
+    out = putValue(out, trafficSpeed);
+    out = putValue(out, lastRowY);
+    out = putValue(out, lastRowSpeed);
+    out = putValue(out, (int32_t)cursor.pattern);
+    out = putValue(out, (int32_t)cursor.row);
+    out = putValue(out, (uint8_t)cursor.mirrored);
+    out = putValue(out, cursor.lastCars);
+    out = putValue(out, player.x);
+    out = putValue(out, player.y);
+    out = putValue(out, player.velocityX);
+    out = putValue(out, player.velocityY);
+
+    out = putValue(out, (uint32_t)obstacles.size());
+    out = putArray(out, obstacles.x);
+    out = putArray(out, obstacles.y);
+    out = putArray(out, obstacles.speed);
+    out = putArray(out, obstacles.carType);
+    out = putValue(out, (uint32_t)coins.size());
+    out = putArray(out, coins.x);
+    out = putArray(out, coins.y);
+    out = putArray(out, coins.speed);
+    out = putArray(out, coins.collected);
+    return out - start;
+}
+
+bool Highway::restoreSnapshot(const uint8_t* in, size_t size) {
+    // Validate the counts and the traffic cursor before touching anything, so
+    // that a bad snapshot leaves the highway as it was and the arrays never
+    // grow past their pools
+    const uint8_t* end = in + size;
+    if (size < SNAPSHOT_FIXED_BYTES) return false;
+
+    const uint8_t* fields = in + SNAPSHOT_CURSOR_OFFSET;
+    int32_t pattern = 0, row = 0;
+    uint8_t mirrored = 0, lastCars = 0;
+    getValue(fields, end, pattern);
+    getValue(fields, end, row);
+    getValue(fields, end, mirrored);
+    getValue(fields, end, lastCars);
+    TrafficCursor cursor;
+    cursor.pattern = pattern;
+    cursor.row = row;
+    cursor.mirrored = mirrored != 0;
+    cursor.lastCars = lastCars;
+    if (!TrafficGenerator::isValid(cursor)) return false;
+
+    const uint8_t* arrays = in + SNAPSHOT_FIXED_BYTES;
+    uint32_t obstacleCount = 0, coinCount = 0;
+    if (!getValue(arrays, end, obstacleCount) || obstacleCount > obstacles.x.capacity() ||
+        (size_t)(end - arrays) < obstacleCount * OBSTACLE_BYTES) {
+        return false;
+    }
+    arrays += obstacleCount * OBSTACLE_BYTES;
+    if (!getValue(arrays, end, coinCount) || coinCount > coins.x.capacity() ||
+        (size_t)(end - arrays) < coinCount * COIN_BYTES) {
+        return false;
+    }
+
+    uint8_t gameOver = 0;
+    uint64_t savedTick = 0;
+    uint32_t rngState[4];
+    getValue(in, end, gameOver);
+    getValue(in, end, score);
+    getValue(in, end, coinCollected);
+    getValue(in, end, currentLevel);
+    getValue(in, end, savedTick);
+    getValue(in, end, backgroundY);
+    getValue(in, end, scoreCarry);
+    for (uint32_t& word : rngState) getValue(in, end, word);
+    getValue(in, end, trafficSpeed);
+    getValue(in, end, lastRowY);
+    getValue(in, end, lastRowSpeed);
+    in = fields; // Cursor already read
+    getValue(in, end, player.x);
+    getValue(in, end, player.y);
+    getValue(in, end, player.velocityX);
+    getValue(in, end, player.velocityY);
+    isGameOver = gameOver != 0;
+    tick = savedTick;
+    worldScale = levelSpeedScale(currentLevel);
+    rng.setState(rngState);
+    traffic.setCursor(cursor);
+
+    in += sizeof(uint32_t);
+    in = getArray(in, obstacleCount, obstacles.x);
+    in = getArray(in, obstacleCount, obstacles.y);
+    in = getArray(in, obstacleCount, obstacles.speed);
+    in = getArray(in, obstacleCount, obstacles.carType);
+    in += sizeof(uint32_t);
+    in = getArray(in, coinCount, coins.x);
+    in = getArray(in, coinCount, coins.y);
+    in = getArray(in, coinCount, coins.speed);
+    in = getArray(in, coinCount, coins.collected);
+    parkedStale = true; // Rewinding restores many snapshots before the next tick
+
+    // Rebuild the broadphase the way a fresh spawn would
+    if (obstacles.size() >= LaneIndex::MIN_ENTITIES) {
+        obstacleIndex.build(obstacles.x.data(), obstacles.y.data(), obstacles.size(), INDEXED_MAX_Y);
+    }
+    if (coins.size() >= LaneIndex::MIN_ENTITIES) {
+        coinIndex.build(coins.x.data(), coins.y.data(), coins.size(), INDEXED_MAX_Y);
+    }
+    lastStep = 0;
+    sweepFrom = playerCollisionBox(player); // Snapshots fall between ticks
+    return true;
+}
+
+// FNV-1a over the raw bytes of a value
+template <typename T>
+static void hashValue(uint64_t& hash, const T& value) {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    for (unsigned char b : bytes) {
+        hash ^= b;
+        hash *= 0x100000001B3ull;
+    }
+}
+
+uint64_t Highway::stateHash() const {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hashValue(hash, tick);
+    hashValue(hash, score);
+    hashValue(hash, coinCollected);
+    hashValue(hash, currentLevel);
+    hashValue(hash, isGameOver);
+    hashValue(hash, backgroundY);
+    hashValue(hash, worldScale);
+    hashValue(hash, trafficSpeed);
+    hashValue(hash, lastRowY);
+    hashValue(hash, traffic.getCursor().pattern);
+    hashValue(hash, traffic.getCursor().row);
+    hashValue(hash, traffic.getCursor().lastCars);
+    hashValue(hash, player.x);
+    hashValue(hash, player.y);
+
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        hashValue(hash, obstacles.x[i]);
+        hashValue(hash, obstacles.y[i]);
+        hashValue(hash, obstacles.speed[i]);
+        hashValue(hash, obstacles.carType[i]);
+    }
+
+    for (size_t i = 0; i < coins.size(); i++) {
+        hashValue(hash, coins.x[i]);
+        hashValue(hash, coins.y[i]);
+        hashValue(hash, coins.speed[i]);
+        hashValue(hash, coins.collected[i]);
+    }
+
+    return hash;
 }
\ No newline at end of file
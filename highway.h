@@ -1,91 +1,170 @@
-#ifndef HIGHWAY_H
-#define HIGHWAY_H
-
-#include <vector>
-#include <memory>
-#include <allegro5/allegro.h>
-
-// Forward declarations
-class Bike;
-class Player;
-class Coin;
-
-// Base class for all game objects
-class GameObject {
-public:
-    virtual ~GameObject() = default;
-    virtual void update() = 0;
-    virtual void draw() = 0;
-};
-
-// Lane configuration constants
-constexpr int LANE_COUNT = 3;
-constexpr int LANE_WIDTH = 200;
-constexpr int FIRST_LANE_X = 100;
-constexpr int LANE_POSITIONS[LANE_COUNT] = {
-    FIRST_LANE_X,
-    FIRST_LANE_X + LANE_WIDTH,
-    FIRST_LANE_X + 2 * LANE_WIDTH
-};
-
-class Obstacle : public GameObject {
-public:
-    static const int WIDTH = 80;
-    static const int HEIGHT = 120;
-    static const char* CAR_IMAGES[3];
-
-    float x, y;
-    float speed;
-    ALLEGRO_BITMAP* image;
-
-    // Collision box padding
-    static constexpr float collisionOffsetX = 15.0f;
-    static constexpr float collisionOffsetY = 20.0f;
-
-    Obstacle(float start_x, float start_y, float speed);
-    ~Obstacle();
-
-    void update() override;
-    void draw() override;
-    bool checkCollision(const Player& player) const;
-
-    float getCollisionX() const { return x + collisionOffsetX; }
-    float getCollisionY() const { return y + collisionOffsetY; }
-    float getCollisionWidth() const { return WIDTH - 2 * collisionOffsetX; }
-    float getCollisionHeight() const { return HEIGHT - 2 * collisionOffsetY; }
-};
-
-class Highway {
-public:
-    bool isGameOver;
-    int score;
-    int coinCollected;  // Track number of coins collected
-    int currentLevel;   // Track current level
-    static const int MAX_LEVEL = 3; // Maximum level
-    static const int COINS_FOR_LEVEL_UP = 12; // Coins needed to level up
-
-    Highway(Bike& bike, Player& player);
-    void update();
-    void draw();
-    void checkCollisions();
-    int getScore() const { return score; }
-    int getLevel() const { return currentLevel; }
-    void increaseLevel(); // Method to handle level-up
-
-private:
-    std::vector<std::unique_ptr<GameObject>> gameObjects;
-    std::vector<std::unique_ptr<GameObject>> coins; // Separate coins collection
-    ALLEGRO_BITMAP* background;
-    Bike& playerBike;
-    Player& player;
-    float backgroundY;
-    float baseSpeed; // Base speed for obstacles
-    float scrollSpeed; // Scrolling speed for background
-
-    void generateObstacles();
-    void spawnCoins();
-    void loadBackground();
-    void checkLevelProgress(); // Check if we should level up
-};
-
+#ifndef HIGHWAY_H
+#define HIGHWAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "broadphase.h"
+#include "coin.h"
+#include "collision.h"
+#include "constants.h"
+#include "levels.h"
+#include "parkedlist.h"
+#include "rng.h"
+#include "traffic.h"
+
+// Forward declarations
+class Player;
+
+class Obstacle {
+public:
+    static const int WIDTH = 80;
+    static const int HEIGHT = 120;
+    static const int CAR_TYPES = 3; // Number of car sprites to pick from
+
+    // Collision box padding
+    static constexpr float collisionOffsetX = 15.0f;
+    static constexpr float collisionOffsetY = 20.0f;
+
+    // Scalar overlap test for a single obstacle at (x, y)
+    static bool checkCollision(float x, float y, const Player& player);
+
+    static float getCollisionWidth() { return WIDTH - 2 * collisionOffsetX; }
+    static float getCollisionHeight() { return HEIGHT - 2 * collisionOffsetY; }
+    static EntityShape getCollisionShape() {
+        return { collisionOffsetX, collisionOffsetY, getCollisionWidth(), getCollisionHeight() };
+    }
+};
+
+// All obstacles on the highway, stored as parallel arrays so the per-tick
+// passes walk contiguous memory instead of chasing pointers
+struct ObstacleArray {
+    std::vector<float> x, y;
+    std::vector<float> speed;
+    std::vector<int> carType; // Sprite index, resolved by the renderer
+    ParkedList parked; // Cars off the road, waiting for place()
+
+    size_t size() const { return x.size(); }
+    bool hasParked() const { return !parked.empty(); }
+    void reserve(size_t capacity); // Fixes the pool size; add() never reallocates after this
+    void clear();
+    void add(float startX, float startY, float startSpeed, int type);
+
+    // Move every obstacle step ticks' worth of its speed. Cars that left the
+    // screen on the previous tick are parked first, until the traffic
+    // generator needs them again; they stay one tick past the bottom so that
+    // the swept collision test sees their whole way down.
+    void update(float step);
+    void parkAll();
+    void collectParked(); // Rebuilds the free list after the arrays were overwritten
+    // Puts the lowest parked car back on the road. Returns its index, or -1
+    // if every car is on the road.
+    int place(float newX, float newY, float newSpeed, int type);
+};
+
+// Pool sizes, traffic density and balancing knobs. The defaults are the
+// shipped game; benchmarks and balancing sweeps (tools/sweep.cpp) vary them.
+struct HighwayConfig {
+    // Pool sizes: the most cars and coins on the road at once. How many are
+    // actually there follows from the traffic density (rowSpacing); a pool
+    // too small for it makes rows spawn short.
+    int obstacleCount = 12;
+    int coinCount = 8;
+    int tickRate = FPS;    // Logic ticks per second; speeds are tuned per FPS tick
+    // Overrides for the level table (levels.cpp); 0 keeps the table
+    int coinsForLevelUp = 0;           // Coins per level needed to level up
+    float levelSpeedMultiplier = 0;    // Speed-up applied on every level-up
+    // Traffic density: pixels between the tops of two rows of cars in a
+    // chunk, on every level. Below Obstacle::HEIGHT rows overlap and chunks
+    // no longer leave room to change lanes: stress tests only.
+    float rowSpacing = 0;
+};
+
+// Game world simulation. Has no Allegro dependency so it can be stepped
+// without a display (see headless.cpp); Renderer draws its state.
+// One call to update() is one fixed logic tick; all randomness comes from the
+// highway's own Rng, so the same seed and inputs reproduce every tick exactly.
+class Highway {
+public:
+    bool isGameOver;
+    int score;
+    int coinCollected;  // Track number of coins collected
+    int currentLevel;   // Track current level (1 to LEVEL_COUNT)
+
+    // All storage is allocated here; update(), checkCollisions() and reset()
+    // never touch the heap afterwards.
+    Highway(Player& player, uint64_t seed, const HighwayConfig& config = HighwayConfig());
+    void reset(uint64_t seed); // Start a new game in place, reusing every buffer
+    void update();
+    // Sweeps the player and every car and coin over the tick update() just
+    // ran, so nothing can pass through the player between two ticks and
+    // the same collisions happen at any tick rate. Coins picked up before
+    // a crash within the tick still count.
+    void checkCollisions();
+    int getScore() const { return score; }
+    int getLevel() const { return currentLevel; }
+    int getCoinTarget() const; // Coins in total that reach the next level; 0 on the last
+    void increaseLevel(); // O(1): swaps the world speed scale, entities keep their speeds
+    unsigned long long getTick() const { return tick; }
+    // How many FPS-rate ticks one logic tick covers (1 at the default rate)
+    float getStepScale() const { return stepScale; }
+    uint64_t stateHash() const; // Fingerprint of the full simulation state
+
+    // Flat, pointer-free copy of the complete simulation state: the fields
+    // above, the Rng, the player and every obstacle and coin. A few hundred
+    // bytes at the shipped density, so saving and restoring are a handful
+    // of memcpys and never allocate. A snapshot restores into any highway
+    // with the same config; the broadphase indices are rebuilt on restore.
+    size_t getSnapshotCapacity() const;      // Most bytes saveSnapshot() writes
+    size_t saveSnapshot(uint8_t* out) const; // Returns the bytes written
+    bool restoreSnapshot(const uint8_t* in, size_t size); // False (and untouched) if malformed
+    const HighwayConfig& getConfig() const { return config; }
+
+    // Read-only state for the renderer
+    const ObstacleArray& getObstacles() const { return obstacles; }
+    const CoinArray& getCoins() const { return coins; }
+    const Player& getPlayer() const { return player; }
+    float getBackgroundY() const { return backgroundY; }
+
+private:
+    HighwayConfig config;
+    ObstacleArray obstacles;
+    CoinArray coins; // Separate coins collection
+    Player& player;
+    unsigned long long tick; // Logic ticks simulated so far
+    float backgroundY;
+    float stepScale;   // FPS / tickRate; every per-tick speed is multiplied by it
+    float worldScale;  // Level speed scale; entity speeds are level 1 speeds
+    float lastStep;    // How far update() moved every speed on the current tick
+    float scoreCarry;  // Fraction of a distance point not yet added to score
+    Rng rng;           // Drives every spawn decision
+    TrafficGenerator traffic;
+    float trafficSpeed; // Level 1 speed of the next row of cars; creeps up with every row
+    float lastRowY;     // Where the most recent row is now, so the next keeps its distance
+    float lastRowSpeed;
+    LaneIndex obstacleIndex; // Broadphase buckets, only kept once there are MIN_ENTITIES cars
+    LaneIndex coinIndex;     // Only built once there are MIN_ENTITIES coins
+    bool parkedStale; // Free lists not yet rebuilt since restoreSnapshot()
+    std::vector<uint32_t> hitMask; // Scratch output of the batch collision tests
+    std::vector<uint32_t> candidates; // Scratch broadphase results
+    std::vector<float> candidateX, candidateY, candidateSpeed;
+    std::vector<float> impact; // Scratch times of impact, per candidate
+    CollisionBox sweepFrom;    // Player box where the previous tick left it
+
+    void generateObstacles();
+    // Every row due on the road down to topY, either entering across topY
+    // during the tick just simulated or laid out in place
+    void spawnRows(float topY, bool entering);
+    void spawnRow(const PatternRow& row, float y, float late); // late: speed-ticks since y
+
+    float rowSpacing() const; // Of the current level, or the config's override
+    float nextRowSpacing(); // From the last row to the next, starting a chunk if one is due
+    float laneChangeDistance(int lanes) const; // Road the next row covers while the player crosses
+    float levelSpeedScale(int level) const;
+    void checkLevelProgress(); // Check if we should level up
+    size_t collideCandidates(const LaneIndex& index, const float* xs, const float* ys,
+        const float* speeds, size_t count, float maxSpeed, const EntityShape& shape,
+        const CollisionBox& from, const CollisionBox& to);
+};
+
 #endif // HIGHWAY_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "hud.h"
+#include "constants.h"
+#include "highway.h"
+#include "snapshot.h"
+#include <cstdio>
+#include <iostream>
+
+static const char* FIELD_NAMES[HudLayer::FIELD_COUNT] = { "score", "level", "coins", "hint" };
+
+// Where each field sits in the layer: the readout is a column on the left,
+// the hint sits at the right of the first row
+struct FieldArea {
+    int x, y, width, height;
+};
+
+static const FieldArea FIELD_AREAS[HudLayer::FIELD_COUNT] = {
+    { 0, 5, SCREEN_WIDTH / 2, 20 },                // Score, text at y = 10
+    { 0, 25, SCREEN_WIDTH / 2, 20 },               // Level, text at y = 30
+    { 0, 45, SCREEN_WIDTH / 2, 20 },               // Coins, text at y = 50
+    { SCREEN_WIDTH / 2, 5, SCREEN_WIDTH / 2, 20 }, // Hint
+};
+
+HudLayer::HudLayer(ALLEGRO_FONT* font, double scoreInterval)
+    : font(font), layer(nullptr), scoreInterval(scoreInterval), scoreRenderedAt(0), valid(false),
+    score(0), level(0), coins(0), coinTarget(0) {
+    // Nearest filtering, like the glyphs it replaces, so the composited text
+    // scales exactly as if it were drawn straight to the screen
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_NEW_BITMAP_PARAMETERS);
+    al_set_new_bitmap_flags(al_get_new_bitmap_flags() & ~(ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR));
+    layer = al_create_bitmap(SCREEN_WIDTH, HEIGHT);
+    al_restore_state(&state);
+    if (!layer) {
+        std::cerr << "Failed to create HUD layer, drawing the HUD directly\n";
+    }
+}
+
+HudLayer::~HudLayer() {
+    if (layer) al_destroy_bitmap(layer);
+}
+
+const char* HudLayer::fieldName(Field field) {
+    return FIELD_NAMES[field];
+}
+
+void HudLayer::renderField(Field field) {
+    char text[32];
+    switch (field) {
+    case SCORE:
+        snprintf(text, sizeof(text), "Score: %d", score);
+        al_draw_text(font, al_map_rgb(255, 255, 255), 10, 10, 0, text);
+        break;
+    case LEVEL:
+        snprintf(text, sizeof(text), "Level: %d", level);
+        al_draw_text(font, al_map_rgb(255, 255, 255), 10, 30, 0, text);
+        break;
+    case COINS:
+        // Coins needed for the next level, or just the count at max level
+        if (coinTarget > 0) {
+            snprintf(text, sizeof(text), "Coins: %d/%d", coins, coinTarget);
+        }
+        else {
+            snprintf(text, sizeof(text), "Coins: %d", coins);
+        }
+        al_draw_text(font, al_map_rgb(255, 215, 0), 10, 50, 0, text);
+        break;
+    case HINT:
+        al_draw_text(font, al_map_rgb(200, 200, 200), SCREEN_WIDTH - 10, 10, ALLEGRO_ALIGN_RIGHT,
+            "M - Toggle Music");
+        break;
+    default:
+        break;
+    }
+}
+
+void HudLayer::draw(const WorldSnapshot& world, double now) {
+    counters.frames++;
+
+    bool dirty[FIELD_COUNT] = {};
+    if (world.score != score && (!valid || now - scoreRenderedAt >= scoreInterval)) {
+        score = world.score;
+        scoreRenderedAt = now;
+        dirty[SCORE] = true;
+    }
+    if (world.level != level) {
+        level = world.level;
+        dirty[LEVEL] = true;
+    }
+    if (world.coinCollected != coins || world.coinTarget != coinTarget) {
+        coins = world.coinCollected;
+        coinTarget = world.coinTarget;
+        dirty[COINS] = true;
+    }
+    if (!valid) {
+        for (bool& field : dirty) field = true;
+        valid = true;
+    }
+
+    if (!layer) {
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            renderField((Field)f);
+        }
+        return;
+    }
+
+    bool any = false;
+    for (bool field : dirty) any = any || field;
+    if (any) {
+        ALLEGRO_STATE state;
+        al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_TRANSFORM);
+        al_set_target_bitmap(layer);
+        ALLEGRO_TRANSFORM identity;
+        al_identity_transform(&identity);
+        al_use_transform(&identity);
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (!dirty[f]) continue;
+            const FieldArea& area = FIELD_AREAS[f];
+            al_set_clipping_rectangle(area.x, area.y, area.width, area.height);
+            al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+            renderField((Field)f);
+            counters.renders[f]++;
+        }
+        al_reset_clipping_rectangle();
+        al_restore_state(&state);
+    }
+
+    al_draw_bitmap(layer, 0, 0, 0);
+}
+
+void HudLayer::printStats() const {
+    std::cout << "HUD re-renders over " << counters.frames << " frames:";
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        std::cout << " " << FIELD_NAMES[f] << " " << counters.renders[f];
+    }
+    std::cout << "\n";
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+
+struct WorldSnapshot;
+
+// The score/level/coins readout and the controls hint, kept rendered in an
+// off-screen layer. A field's text is only re-rasterized when its value
+// changes (the score, which changes almost every tick, at most
+// scoreInterval seconds apart); every frame just composites the layer with
+// one blit. Transient messages (level-up banner, pause) are drawn directly.
+class HudLayer {
+public:
+    enum Field {
+        SCORE,
+        LEVEL,
+        COINS,
+        HINT,
+        FIELD_COUNT
+    };
+
+    struct Counters {
+        unsigned long renders[FIELD_COUNT] = {}; // Times each field was re-rasterized
+        unsigned long frames = 0;
+    };
+
+    static const int HEIGHT = 70; // Logical pixels from the top of the screen
+
+    // Creates the layer bitmap, so the display must exist
+    HudLayer(ALLEGRO_FONT* font, double scoreInterval);
+    ~HudLayer();
+
+    // Brings changed fields up to date and draws the layer through the
+    // current transform. now is on the al_get_time() clock.
+    void draw(const WorldSnapshot& world, double now);
+    void invalidate() { valid = false; } // Re-render everything (e.g. after the display was lost)
+
+    const Counters& getCounters() const { return counters; }
+    static const char* fieldName(Field field);
+    void printStats() const;
+
+private:
+    ALLEGRO_FONT* font;
+    ALLEGRO_BITMAP* layer; // Null if it could not be created; fields are then drawn every frame
+    double scoreInterval;
+    double scoreRenderedAt;
+    bool valid;
+
+    // Values the layer currently shows
+    int score;
+    int level;
+    int coins;
+    int coinTarget; // 0 at max level, where there is nothing left to collect for
+
+    Counters counters;
+
+    void renderField(Field field);
+};
+
+#endif // HUD_H
\ No newline at end of file
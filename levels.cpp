@@ -0,0 +1,40 @@
+#include "levels.h"
+#include "highway.h"
+#include "traffic.h"
+
+// The shipped progression: 25% faster and denser traffic every level, a
+// level-up every 12 coins (coinTarget is the running total: 12, then 24),
+// and a bonus of 500 times the number of the level reached. The row spacing
+// keeps about five cars on the screen at a time, with up to a dozen in the
+// densest stretches (HighwayConfig's pools hold that many).
+static constexpr LevelParams LEVELS[LEVEL_COUNT] = {
+    { 1.0f, 1, 160.0f, 12, 0 },
+    { 1.25f, 2, 180.0f, 24, 1000 },
+    { 1.5625f, 2, 150.0f, 0, 1500 },
+};
+
+static constexpr bool levelsValid() {
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        const LevelParams& level = LEVELS[i];
+        bool last = i == LEVEL_COUNT - 1;
+        if (level.speedScale <= 0 || level.trafficTier < 0 ||
+            level.trafficTier >= TrafficGenerator::TIERS || level.rowSpacing < Obstacle::HEIGHT) {
+            return false;
+        }
+        // Targets keep rising and only the last level has none
+        if (last ? level.coinTarget != 0 :
+            level.coinTarget <= (i > 0 ? LEVELS[i - 1].coinTarget : 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(LEVELS[0].speedScale == 1.0f, "level 1 is the speed every other level scales");
+static_assert(levelsValid(), "every level needs a positive speed, a known traffic tier, "
+    "rows at least a car apart and a coin target above the last");
+
+const LevelParams& level_params(int level) {
+    int index = level < 1 ? 0 : (level > LEVEL_COUNT ? LEVEL_COUNT : level) - 1;
+    return LEVELS[index];
+}
\ No newline at end of file
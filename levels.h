@@ -0,0 +1,21 @@
+#ifndef LEVELS_H
+#define LEVELS_H
+
+// What changes from one level to the next. Speeds are not stored per level;
+// the whole world (road, cars and coins) moves at speedScale times its level
+// 1 speed, so a level-up only swaps the scale and never touches an entity.
+struct LevelParams {
+    float speedScale; // World speed relative to level 1
+    int trafficTier;  // Pattern table the traffic generator draws from
+    float rowSpacing; // Pixels between the tops of two rows of cars in a chunk
+    int coinTarget;   // Coins collected in total to reach the next level; 0 on the last
+    int bonus;        // Points for reaching this level
+};
+
+constexpr int LEVEL_COUNT = 3;
+
+// Parameters of a 1-based level; levels outside the table get its first or
+// last entry
+const LevelParams& level_params(int level);
+
+#endif // LEVELS_H
\ No newline at end of file
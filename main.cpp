@@ -1,19 +1,90 @@
-#include "game.h"
-
-int main() {
-    if (!initialize_allegro()) {
-        return -1;
-    }
-
-    if (!initialize_game()) {
-        cleanup_allegro();
-        return -1;
-    }
-
-    Alma();//run_game
-
-    cleanup_game();
-    cleanup_allegro();
-
-    return 0;
+#include "game.h"
+#include "headless.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+int main(int argc, char** argv) {
+    bool headless = false;
+    unsigned long long headlessTicks = 1000000;
+    GameOptions options;
+    options.seed = static_cast<uint64_t>(time(nullptr));
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            headlessTicks = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--profile-out") == 0 && i + 1 < argc) {
+            options.profileOut = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            int rate = atoi(argv[++i]);
+            if (rate > 0) options.tickRate = rate;
+        }
+        else if (strcmp(argv[i], "--max-catch-up") == 0 && i + 1 < argc) {
+            int ticks = atoi(argv[++i]);
+            if (ticks > 0) options.maxCatchUp = ticks;
+        }
+        else if (strcmp(argv[i], "--hud-score-rate") == 0 && i + 1 < argc) {
+            int rate = atoi(argv[++i]);
+            if (rate > 0) options.hudScoreRate = rate;
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+            options.seekTick = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            options.capturePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture-threads") == 0 && i + 1 < argc) {
+            int threads = atoi(argv[++i]);
+            if (threads > 0) options.captureEncoders = threads;
+        }
+        else if (strcmp(argv[i], "--capture-queue") == 0 && i + 1 < argc) {
+            int frames = atoi(argv[++i]);
+            if (frames > 0) options.captureQueue = frames;
+        }
+    }
+
+    // Print the seed so any run can be reproduced with --seed
+    std::cout << "Seed: " << options.seed << "\n";
+
+    // Replay rendered straight to disk, no display required
+    if (headless && options.replayPath && options.capturePath) {
+        return capture_replay(options);
+    }
+    // Simulation only, no display required
+    if (headless && options.replayPath) {
+        return run_replay(options.replayPath, options.seekTick);
+    }
+    if (headless) {
+        return run_headless(headlessTicks, options.seed);
+    }
+
+    if (!initialize_allegro()) {
+        return -1;
+    }
+
+    if (!initialize_game()) {
+        cleanup_allegro();
+        return -1;
+    }
+
+    Alma(options);//run_game
+
+    cleanup_game();
+    cleanup_allegro();
+
+    return 0;
 }
\ No newline at end of file
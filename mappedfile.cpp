@@ -0,0 +1,89 @@
+#include "mappedfile.h"
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile() : bytes(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {
+}
+#else
+MappedFile::MappedFile() : bytes(nullptr), length(0), descriptor(-1) {
+}
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const char* path) {
+    close();
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) {
+        std::cerr << "Failed to open " << path << "\n";
+        close();
+        return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0) return true; // Nothing to map
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+        bytes = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!bytes) {
+        std::cerr << "Failed to map " << path << "\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    bytes = nullptr;
+    length = 0;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::open(const char* path) {
+    close();
+    descriptor = ::open(path, O_RDONLY);
+    struct stat info;
+    if (descriptor < 0 || fstat(descriptor, &info) != 0) {
+        std::cerr << "Failed to open " << path << "\n";
+        close();
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length == 0) return true; // mmap rejects empty files
+
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (address == MAP_FAILED) {
+        std::cerr << "Failed to map " << path << "\n";
+        close();
+        return false;
+    }
+    bytes = (const uint8_t*)address;
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) munmap((void*)bytes, length);
+    if (descriptor >= 0) ::close(descriptor);
+    bytes = nullptr;
+    length = 0;
+    descriptor = -1;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef PARKEDLIST_H
+#define PARKEDLIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Free list of the parked slots of an entity pool (ObstacleArray, CoinArray).
+// The indices are kept as a min-heap, so takeLowest() always reuses the
+// lowest parked slot: which slot a new car or coin lands in depends only on
+// which slots are parked, not on the order they left the road, and so
+// survives a snapshot round trip. Sized by reserve(), so it never grows.
+class ParkedList {
+public:
+    void reserve(size_t capacity) { heap.resize(capacity); }
+    void clear() { count = 0; }
+    bool empty() const { return count == 0; }
+
+    void push(uint32_t index) {
+        heap[count++] = index;
+        std::push_heap(heap.begin(), heap.begin() + count, std::greater<uint32_t>());
+    }
+    // Removes and returns the lowest parked index; the list must not be empty
+    uint32_t takeLowest() {
+        std::pop_heap(heap.begin(), heap.begin() + count, std::greater<uint32_t>());
+        return heap[--count];
+    }
+
+    // Every slot below size is parked
+    void parkAll(size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            heap[i] = (uint32_t)i; // Ascending order is already a min-heap
+        }
+        count = size;
+    }
+    // Rebuilds the list from a pool's speed column, where parked slots have
+    // speed 0. Branch-free compaction in ascending order, so already a min-heap.
+    void collect(const float* speed, size_t size) {
+        uint32_t* out = heap.data();
+        size_t found = 0;
+        for (size_t i = 0; i < size; i++) {
+            out[found] = (uint32_t)i;
+            found += speed[i] == 0;
+        }
+        count = found;
+    }
+
+private:
+    std::vector<uint32_t> heap; // The first count entries are the parked slots
+    size_t count = 0;
+};
+
+#endif // PARKEDLIST_H
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+Profiler::Profiler() : next(0), count(0), pendingTicks(0), totalFrames(0) {
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        pendingNs[p] = 0;
+    }
+}
+
+const char* Profiler::phaseName(Phase phase) {
+    static const char* names[PHASE_COUNT] = {
+        "player", "highway", "collide", "draw", "hud", "capture", "flip"
+    };
+    return names[phase];
+}
+
+void Profiler::endFrame() {
+    // Ticks that finish while this runs simply land in the next frame
+    Frame current;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        current.ms[p] = pendingNs[p].exchange(0, std::memory_order_relaxed) / 1e6f;
+    }
+    current.ticks = pendingTicks.exchange(0, std::memory_order_relaxed);
+
+    frames[next] = current;
+    next = (next + 1) % CAPACITY;
+    if (count < CAPACITY) count++;
+    totalFrames++;
+}
+
+Profiler::PhaseStats Profiler::getStats(Phase phase) const {
+    PhaseStats stats = { 0, 0, 0 };
+    size_t n = count < STATS_WINDOW ? count : STATS_WINDOW;
+    if (n == 0) return stats;
+
+    float sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        float ms = frames[(next + CAPACITY - 1 - i) % CAPACITY].ms[phase];
+        scratch[i] = ms;
+        sum += ms;
+    }
+
+    // Nearest-rank percentile; only the 99th needs to be in place
+    size_t rank = (n * 99 + 99) / 100 - 1;
+    std::nth_element(scratch, scratch + rank, scratch + n);
+    stats.p99 = scratch[rank];
+    stats.min = *std::min_element(scratch, scratch + n);
+    stats.avg = sum / n;
+    return stats;
+}
+
+bool Profiler::writeCsv(const char* path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open profile output: " << path << "\n";
+        return false;
+    }
+
+    out << "frame,ticks";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        out << "," << phaseName((Phase)p) << "_ms";
+    }
+    out << "\n";
+
+    // Frame numbers count from the start of the game, even after the ring wrapped
+    size_t first = (next + CAPACITY - count) % CAPACITY;
+    unsigned long long firstFrame = totalFrames - count;
+    for (size_t i = 0; i < count; i++) {
+        const Frame& frame = frames[(first + i) % CAPACITY];
+        out << firstFrame + i << "," << frame.ticks;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            out << "," << frame.ms[p];
+        }
+        out << "\n";
+    }
+    return true;
+}
\ No newline at end of file
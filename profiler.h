@@ -0,0 +1,86 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Per-phase frame timings for the game loop. Phase times are accumulated
+// into the current frame by ProfileScope, and endFrame() pushes the frame
+// into a fixed-size ring buffer. Recording never allocates.
+// addTime() and countTick() may be called from the simulation thread while
+// the render thread ends frames; everything else is render-thread only.
+class Profiler {
+public:
+    enum Phase {
+        PLAYER_UPDATE,
+        HIGHWAY_UPDATE,
+        COLLISIONS,
+        DRAW,
+        HUD,
+        CAPTURE, // Backbuffer readback for --capture
+        FLIP,
+        PHASE_COUNT
+    };
+
+    static const size_t CAPACITY = 32768;    // Frames kept (~6.8 minutes at 80 FPS)
+    static const size_t STATS_WINDOW = 240;  // Frames summarized by getStats()
+
+    struct Frame {
+        float ms[PHASE_COUNT]; // Time spent in each phase
+        int ticks;             // Logic ticks simulated for this frame
+    };
+
+    struct PhaseStats {
+        float min, avg, p99; // Milliseconds
+    };
+
+    Profiler();
+
+    static const char* phaseName(Phase phase);
+
+    void addTime(Phase phase, double ms) {
+        pendingNs[phase].fetch_add((uint64_t)(ms * 1e6), std::memory_order_relaxed);
+    }
+    void countTick() { pendingTicks.fetch_add(1, std::memory_order_relaxed); }
+    void endFrame();
+
+    unsigned long long getFrameCount() const { return totalFrames; }
+
+    // min/avg/p99 of a phase over the last STATS_WINDOW frames
+    PhaseStats getStats(Phase phase) const;
+
+    // Writes every buffered frame as CSV (oldest first)
+    bool writeCsv(const char* path) const;
+
+private:
+    Frame frames[CAPACITY];
+    size_t next;  // Ring position of the next frame
+    size_t count; // Frames buffered (up to CAPACITY)
+    std::atomic<uint64_t> pendingNs[PHASE_COUNT]; // Current frame, in nanoseconds
+    std::atomic<int> pendingTicks;
+    unsigned long long totalFrames;
+    mutable float scratch[STATS_WINDOW]; // Sorting space for getStats()
+};
+
+// Adds the lifetime of the scope to a phase of the current frame
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, Profiler::Phase phase)
+        : profiler(profiler), phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope() {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        profiler.addTime(phase, elapsed.count());
+    }
+
+private:
+    Profiler& profiler;
+    Profiler::Phase phase;
+    std::chrono::steady_clock::time_point start;
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif // PROFILER_H
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "renderer.h"
+#include "assetloader.h"
+#include "game.h"
+#include "bike.h"
+#include "coin.h"
+#include "spritecache.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+const char* Renderer::CAR_IMAGES[Obstacle::CAR_TYPES] = {
+    "assets/car1.png",
+    "assets/car2.png",
+    "assets/car3.png"
+};
+
+const char* BACKGROUND_IMAGE = "assets/background.png";
+const char* COIN_IMAGE = "assets/coin.png";
+
+static ALLEGRO_BITMAP* createCarFallback(int width, int height) {
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    ALLEGRO_BITMAP* image = al_create_bitmap(width, height);
+    al_set_target_bitmap(image);
+    al_clear_to_color(al_map_rgb(255, 0, 0));
+    al_restore_state(&state);
+    return image;
+}
+
+static ALLEGRO_BITMAP* createCoinFallback(int width, int height) {
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    ALLEGRO_BITMAP* image = al_create_bitmap(width, height);
+    al_set_target_bitmap(image);
+    al_clear_to_color(al_map_rgb(255, 215, 0)); // Gold color
+    al_draw_filled_circle(width / 2, height / 2, width / 2 - 2, al_map_rgb(255, 215, 0));
+    al_draw_circle(width / 2, height / 2, width / 2 - 2, al_map_rgb(200, 170, 0), 1);
+    al_restore_state(&state);
+    return image;
+}
+
+static ALLEGRO_BITMAP* createBackgroundFallback(int width, int height) {
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    ALLEGRO_BITMAP* image = al_create_bitmap(width, height);
+    al_set_target_bitmap(image);
+    al_clear_to_color(al_map_rgb(50, 50, 150));
+
+    // Lane markings, scaled along with the rest of the view
+    float scale = (float)width / SCREEN_WIDTH;
+    for (int i = 0; i <= LANE_COUNT; i++) {
+        float x = (FIRST_LANE_X + i * LANE_WIDTH) * scale;
+        al_draw_line(x, 0, x, height, al_map_rgb(255, 255, 255), 2 * scale);
+    }
+
+    al_restore_state(&state);
+    return image;
+}
+
+void Renderer::queueAssets() {
+    AssetLoader& loader = AssetLoader::instance();
+    loader.queueBitmap(BACKGROUND_IMAGE);
+    for (const char* path : CAR_IMAGES) {
+        loader.queueBitmap(path);
+    }
+    loader.queueBitmap(COIN_IMAGE);
+}
+
+Renderer::Renderer(Bike& bike)
+    : playerBike(bike), background(nullptr), carImages(), coinImage(nullptr),
+    carSprites(), coinSprite(nullptr), bikeSprite(nullptr),
+    viewScale(1.0f), viewX(0), viewY(0), batchTexture(nullptr),
+    frames(0), totalDrawCalls(0), totalBatches(0) {
+    al_identity_transform(&hudTransform);
+    ALLEGRO_DISPLAY* display = al_get_current_display();
+    if (display) {
+        resize(al_get_display_width(display), al_get_display_height(display));
+    }
+    else {
+        loadSprites();
+    }
+}
+
+Renderer::~Renderer() {
+    releaseSprites();
+}
+
+int Renderer::scaled(int logicalSize) const {
+    return std::max(1, (int)std::lround(logicalSize * viewScale));
+}
+
+void Renderer::resize(int displayWidth, int displayHeight) {
+    // Largest uniform scale that fits, centered with black bars
+    viewScale = std::min((float)displayWidth / SCREEN_WIDTH, (float)displayHeight / SCREEN_HEIGHT);
+    viewX = std::floor((displayWidth - SCREEN_WIDTH * viewScale) / 2);
+    viewY = std::floor((displayHeight - SCREEN_HEIGHT * viewScale) / 2);
+    al_build_transform(&hudTransform, viewX, viewY, viewScale, viewScale, 0);
+
+    reloadSprites();
+}
+
+void Renderer::reloadSprites() {
+    releaseSprites();
+    playerBike.setScale(viewScale);
+    loadSprites();
+
+    // Drop the variants made for the previous size
+    SpriteCache::instance().trim();
+}
+
+void Renderer::releaseSprites() {
+    atlas.clear();
+
+    SpriteCache& cache = SpriteCache::instance();
+    for (ALLEGRO_BITMAP*& image : carImages) {
+        cache.release(image);
+        image = nullptr;
+    }
+    cache.release(coinImage);
+    cache.release(background);
+    coinImage = nullptr;
+    background = nullptr;
+}
+
+void Renderer::loadSprites() {
+    SpriteCache& cache = SpriteCache::instance();
+    background = cache.acquire(BACKGROUND_IMAGE, scaled(SCREEN_WIDTH), scaled(SCREEN_HEIGHT),
+        ScaleMode::Stretch, createBackgroundFallback);
+
+    // Cars and coins are resampled once to their exact on-screen size, so
+    // every entity is drawn 1:1 straight out of the atlas
+    int carRegions[Obstacle::CAR_TYPES];
+    for (int i = 0; i < Obstacle::CAR_TYPES; i++) {
+        carImages[i] = cache.acquire(CAR_IMAGES[i], scaled(Obstacle::WIDTH), scaled(Obstacle::HEIGHT),
+            ScaleMode::Stretch, createCarFallback);
+        carRegions[i] = atlas.add(carImages[i]);
+    }
+    coinImage = cache.acquire(COIN_IMAGE, scaled(Coin::WIDTH), scaled(Coin::HEIGHT),
+        ScaleMode::Stretch, createCoinFallback);
+    int coinRegion = atlas.add(coinImage);
+    int bikeRegion = atlas.add(playerBike.getImage());
+
+    atlas.build();
+    for (int i = 0; i < Obstacle::CAR_TYPES; i++) {
+        carSprites[i] = atlas.region(carRegions[i]);
+    }
+    coinSprite = atlas.region(coinRegion);
+    bikeSprite = atlas.region(bikeRegion);
+}
+
+// x, y are logical coordinates, mapped to the display here
+void Renderer::drawSprite(ALLEGRO_BITMAP* sprite, float x, float y) {
+    ALLEGRO_BITMAP* texture = al_get_parent_bitmap(sprite);
+    if (!texture) texture = sprite;
+    if (!al_is_bitmap_drawing_held() || texture != batchTexture) {
+        frameStats.batches++;
+        batchTexture = texture;
+    }
+    frameStats.drawCalls++;
+    al_draw_bitmap(sprite, viewX + x * viewScale, viewY + y * viewScale, 0);
+}
+
+// Position of something scrolling down between two ticks. A value that went
+// backwards was respawned at the top, so it is shown where it is now.
+static float interpolateScroll(float previous, float current, float alpha) {
+    if (current < previous) return current;
+    return previous + (current - previous) * alpha;
+}
+
+void Renderer::draw(const WorldSnapshot& world, float alpha) {
+    frameStats = FrameStats();
+    batchTexture = nullptr;
+
+    // The world is drawn in display pixels, clipped to the letterboxed view
+    ALLEGRO_TRANSFORM identity;
+    al_identity_transform(&identity);
+    al_use_transform(&identity);
+    al_set_clipping_rectangle((int)viewX, (int)viewY, scaled(SCREEN_WIDTH), scaled(SCREEN_HEIGHT));
+
+    // Draw the background
+    if (background) {
+        // Draw the background twice for scrolling effect
+        // The background wraps back to 0; continue it past the seam instead
+        float previousY = world.previousBackgroundY;
+        if (world.backgroundY < previousY) previousY -= SCREEN_HEIGHT;
+        float backgroundY = previousY + (world.backgroundY - previousY) * alpha;
+        drawSprite(background, 0, backgroundY - SCREEN_HEIGHT);
+        drawSprite(background, 0, backgroundY);
+    }
+
+    // Every entity sprite is a sub-bitmap of the atlas, so while drawing is
+    // held Allegro merges the whole pass into a single batch. Only bitmap
+    // draws are allowed until the hold is released.
+    al_hold_bitmap_drawing(true);
+    drawObstacles(world, alpha);
+    drawCoins(world, alpha);
+    float playerX = world.previousPlayerX + (world.playerX - world.previousPlayerX) * alpha;
+    if (bikeSprite) {
+        drawSprite(bikeSprite, playerX, world.playerY);
+    }
+    al_hold_bitmap_drawing(false);
+
+    // Placeholder rectangle if even the fallback bike sprite is missing
+    if (!bikeSprite) {
+        playerBike.draw(viewX + playerX * viewScale, viewY + world.playerY * viewScale);
+    }
+
+    al_reset_clipping_rectangle();
+    al_use_transform(&hudTransform);
+
+    frames++;
+    totalDrawCalls += frameStats.drawCalls;
+    totalBatches += frameStats.batches;
+}
+
+void Renderer::drawObstacles(const WorldSnapshot& world, float alpha) {
+    const ObstacleArray& obstacles = world.obstacles;
+    const size_t count = obstacles.size();
+    for (size_t i = 0; i < count; i++) {
+        if (obstacles.y[i] > SCREEN_HEIGHT) continue; // Parked
+        ALLEGRO_BITMAP* sprite = carSprites[obstacles.carType[i]];
+        if (sprite) {
+            drawSprite(sprite, obstacles.x[i],
+                interpolateScroll(world.previousObstacleY[i], obstacles.y[i], alpha));
+        }
+    }
+}
+
+void Renderer::drawCoins(const WorldSnapshot& world, float alpha) {
+    if (!coinSprite) return;
+
+    const CoinArray& coins = world.coins;
+    const size_t count = coins.size();
+    for (size_t i = 0; i < count; i++) {
+        if (coins.collected[i] || coins.y[i] > SCREEN_HEIGHT) continue; // Collected or parked
+
+        float x = coins.x[i];
+        float y = interpolateScroll(world.previousCoinY[i], coins.y[i], alpha);
+        drawSprite(coinSprite, x, y);
+
+        /* Debug collision box (uncomment if needed, outside the held pass)
+        al_draw_rectangle(
+            x + Coin::COLLISION_PADDING, y + Coin::COLLISION_PADDING,
+            x + Coin::WIDTH - Coin::COLLISION_PADDING, y + Coin::HEIGHT - Coin::COLLISION_PADDING,
+            al_map_rgba(0, 255, 0, 128), 1
+        );*/
+    }
+}
+
+void Renderer::printStats() const {
+    if (frames == 0) return;
+    std::cout << "Renderer: " << frames << " frames, "
+        << (double)totalDrawCalls / frames << " draw calls / "
+        << (double)totalBatches / frames << " batches per frame\n";
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <allegro5/allegro.h>
+#include "highway.h"
+#include "snapshot.h"
+#include "spriteatlas.h"
+
+class Bike;
+
+// Draws snapshots of a Highway simulation. Owns every sprite used for the
+// world so that the simulation itself never touches Allegro.
+class Renderer {
+public:
+    static const char* CAR_IMAGES[Obstacle::CAR_TYPES];
+
+    // Draw calls issued for the last frame, and how many texture batches they
+    // needed (a new batch starts whenever the source texture changes or
+    // drawing is not held)
+    struct FrameStats {
+        int drawCalls = 0;
+        int batches = 0;
+    };
+
+    Renderer(Bike& bike);
+    ~Renderer();
+
+    static void queueAssets(); // Start decoding every world sprite in the background
+
+    // Draws the world letterboxed into the display, then leaves a transform
+    // in place so HUD code can keep drawing in logical SCREEN_WIDTH x
+    // SCREEN_HEIGHT coordinates. alpha in [0, 1] blends moving things from
+    // their state before the snapshot's tick (0) to the snapshot itself (1).
+    void draw(const WorldSnapshot& world, float alpha);
+
+    // Fits the view to a new display size and re-scales every sprite for it
+    void resize(int displayWidth, int displayHeight);
+    // Regenerates every sprite variant at the current size (e.g. after the
+    // display was lost and found again)
+    void reloadSprites();
+
+    const FrameStats& getFrameStats() const { return frameStats; }
+    void printStats() const; // Averages over every frame drawn so far
+
+private:
+    Bike& playerBike;
+    ALLEGRO_BITMAP* background;
+    ALLEGRO_BITMAP* carImages[Obstacle::CAR_TYPES]; // Sprite cache references
+    ALLEGRO_BITMAP* coinImage;
+
+    // Everything drawn in the entity pass lives in one atlas
+    SpriteAtlas atlas;
+    ALLEGRO_BITMAP* carSprites[Obstacle::CAR_TYPES];
+    ALLEGRO_BITMAP* coinSprite;
+    ALLEGRO_BITMAP* bikeSprite;
+
+    // Logical-to-display mapping: sprites are pre-scaled by viewScale so the
+    // per-frame path only blits them 1:1
+    float viewScale;
+    float viewX, viewY; // Letterbox offset
+    ALLEGRO_TRANSFORM hudTransform;
+
+    FrameStats frameStats;
+    ALLEGRO_BITMAP* batchTexture; // Texture of the current batch
+    unsigned long frames;
+    unsigned long totalDrawCalls;
+    unsigned long totalBatches;
+
+    void loadSprites();
+    void releaseSprites();
+    int scaled(int logicalSize) const;
+    void drawSprite(ALLEGRO_BITMAP* sprite, float x, float y);
+    void drawObstacles(const WorldSnapshot& world, float alpha);
+    void drawCoins(const WorldSnapshot& world, float alpha);
+};
+
+#endif // RENDERER_H
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include "replay.h"
+#include "bytestream.h"
+#include "environment.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+static const char MAGIC[4] = { 'T', 'R', 'R', 'P' };
+static const uint8_t VERSION = 5; // 2: pattern traffic, 3: world speed scale, 4: swept collisions, 5: row spacing
+// Largest entity count a header may ask for; well above any real run (the
+// benchmark tops out at 100k) but small enough that a damaged header cannot
+// make the highway reserve gigabytes
+static const int32_t MAX_ENTITIES = 1 << 20;
+
+enum RecordTag : uint8_t {
+    INPUT_TAG = 1,
+    KEYFRAME_TAG = 2,
+    END_TAG = 3
+};
+
+// LEB128: 7 bits per byte, low bits first; most tick deltas fit in one byte
+static uint8_t* putVarint(uint8_t* out, unsigned long long value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static bool getVarint(const uint8_t*& in, const uint8_t* end, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in == end) return false;
+        uint8_t byte = *in++;
+        value |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+ReplayWriter::ReplayWriter()
+    : file(nullptr), lastTick(0), lastSteering(0), rewindWindow(0),
+    queuedStart(0), queuedEnd(0), stopping(false) {
+}
+
+ReplayWriter::~ReplayWriter() {
+    if (file) finish(); // Abandoned without close(): no end record
+}
+
+bool ReplayWriter::open(const char* path, uint64_t seed, const Highway& highway) {
+    file = fopen(path, "wb");
+    if (!file) {
+        std::cerr << "Failed to open replay file for writing: " << path << "\n";
+        return false;
+    }
+
+    const HighwayConfig& config = highway.getConfig();
+    const size_t keyframeBytes = highway.getSnapshotCapacity() + 32;
+    buffer.resize(keyframeBytes);
+
+    // Room for a window's worth of held-back records: at most one input per
+    // tick plus the keyframes that fall inside the window
+    const size_t windowKeyframes = rewindWindow / KEYFRAME_INTERVAL + 2;
+    pending.clear();
+    pending.reserve(rewindWindow * 12 + windowKeyframes * keyframeBytes);
+    marks.clear();
+    marks.reserve(rewindWindow + windowKeyframes);
+
+    // A few keyframes of slack before the tick thread would have to wait
+    outgoing.resize(std::max<size_t>(1 << 16, 4 * keyframeBytes));
+    queuedStart = 0;
+    queuedEnd = 0;
+    stopping = false;
+    writer = std::thread(&ReplayWriter::writerLoop, this);
+
+    uint8_t header[64];
+    uint8_t* out = header;
+    memcpy(out, MAGIC, sizeof(MAGIC));
+    out += sizeof(MAGIC);
+    out = putValue(out, VERSION);
+    out = putValue(out, seed);
+    out = putValue(out, (int32_t)config.obstacleCount);
+    out = putValue(out, (int32_t)config.coinCount);
+    out = putValue(out, (int32_t)config.tickRate);
+    out = putValue(out, (int32_t)config.coinsForLevelUp);
+    out = putValue(out, config.levelSpeedMultiplier);
+    out = putValue(out, config.rowSpacing);
+    out = putValue(out, (uint32_t)KEYFRAME_INTERVAL);
+    send(header, out - header);
+
+    // The first keyframe is never taken back, so a reader always has one
+    writeKeyframe(highway, 0);
+    commit(marks.size());
+    return true;
+}
+
+void ReplayWriter::emit(const uint8_t* bytes, size_t size, unsigned long long tick) {
+    if (rewindWindow == 0) {
+        send(bytes, size);
+        return;
+    }
+
+    // Never grow the buffers; a full buffer just loses its rewind history
+    if (pending.size() + size > pending.capacity() || marks.size() == marks.capacity()) {
+        commit(marks.size());
+    }
+    marks.push_back({ tick, pending.size(), lastTick, lastSteering });
+    pending.insert(pending.end(), bytes, bytes + size);
+
+    // Records older than the window can no longer be taken back
+    size_t old = 0;
+    while (old < marks.size() && marks[old].tick + rewindWindow < tick) old++;
+    commit(old);
+}
+
+void ReplayWriter::commit(size_t count) {
+    if (count == 0) return;
+    size_t bytes = count < marks.size() ? marks[count].offset : pending.size();
+    send(pending.data(), bytes);
+    pending.erase(pending.begin(), pending.begin() + bytes);
+    marks.erase(marks.begin(), marks.begin() + count);
+    for (Mark& mark : marks) {
+        mark.offset -= bytes;
+    }
+}
+
+void ReplayWriter::send(const uint8_t* bytes, size_t size) {
+    const size_t capacity = outgoing.size();
+    while (size > 0) {
+        size_t end;
+        size_t room;
+        {
+            // Only waits when the writer has fallen a whole ring behind
+            std::unique_lock<std::mutex> lock(mutex);
+            spaceFree.wait(lock, [this, capacity] { return queuedEnd - queuedStart < capacity; });
+            end = queuedEnd;
+            room = capacity - (queuedEnd - queuedStart);
+        }
+        size_t at = end % capacity;
+        size_t count = std::min(std::min(size, room), capacity - at);
+        memcpy(outgoing.data() + at, bytes, count);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queuedEnd += count;
+        }
+        bytesQueued.notify_one();
+        bytes += count;
+        size -= count;
+    }
+}
+
+void ReplayWriter::writerLoop() {
+    const size_t capacity = outgoing.size();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        bytesQueued.wait(lock, [this] { return queuedEnd != queuedStart || stopping; });
+        if (queuedEnd == queuedStart) break; // Stopping, and everything is written
+        size_t start = queuedStart;
+        const size_t end = queuedEnd;
+        lock.unlock();
+
+        while (start != end) {
+            size_t at = start % capacity;
+            size_t count = std::min(end - start, capacity - at);
+            fwrite(outgoing.data() + at, 1, count, file);
+            start += count;
+        }
+        fflush(file); // Keep the file readable if the game dies after this
+
+        lock.lock();
+        queuedStart = end;
+        spaceFree.notify_one();
+    }
+}
+
+void ReplayWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    bytesQueued.notify_one();
+    writer.join();
+    fclose(file);
+    file = nullptr;
+}
+
+void ReplayWriter::writeKeyframe(const Highway& highway, int steering) {
+    // Tag, tick and steering go in front of the state; the size varint is
+    // written after the state is, so the state is serialized at a fixed gap
+    uint8_t* out = buffer.data();
+    *out++ = KEYFRAME_TAG;
+    out = putVarint(out, highway.getTick());
+    *out++ = (uint8_t)(int8_t)steering;
+    uint8_t* stateStart = out + 10; // Room for the largest varint
+    size_t size = highway.saveSnapshot(stateStart);
+    uint8_t* sizeEnd = putVarint(out, size);
+    memmove(sizeEnd, stateStart, size);
+    emit(buffer.data(), (sizeEnd + size) - buffer.data(), highway.getTick());
+
+    lastTick = highway.getTick();
+    lastSteering = steering;
+}
+
+void ReplayWriter::recordTick(const Highway& highway, int steering) {
+    if (!file) return;
+
+    unsigned long long tick = highway.getTick();
+    if (tick % KEYFRAME_INTERVAL == 0 && tick != lastTick) {
+        writeKeyframe(highway, steering);
+        return;
+    }
+    if (steering == lastSteering) return;
+
+    uint8_t record[16];
+    uint8_t* out = record;
+    *out++ = INPUT_TAG;
+    out = putVarint(out, tick - lastTick);
+    *out++ = (uint8_t)(int8_t)steering;
+    emit(record, out - record, tick);
+    lastTick = tick;
+    lastSteering = steering;
+}
+
+void ReplayWriter::rewind(const Highway& highway) {
+    if (!file) return;
+
+    // Records at the rewound-to tick stay: the state there is unchanged and
+    // a new record for the same tick would simply override them
+    unsigned long long tick = highway.getTick();
+    size_t keep = 0;
+    while (keep < marks.size() && marks[keep].tick <= tick) keep++;
+    if (keep < marks.size()) {
+        lastTick = marks[keep].lastTick;
+        lastSteering = marks[keep].lastSteering;
+        pending.resize(marks[keep].offset);
+        marks.resize(keep);
+    }
+
+    if (lastTick > tick) {
+        std::cerr << "Rewound past the replay's rewind window; recording stopped at tick "
+            << lastTick << "\n";
+        commit(marks.size());
+        finish();
+    }
+}
+
+void ReplayWriter::close(const Highway& highway) {
+    if (!file) return;
+    commit(marks.size());
+
+    uint8_t record[32];
+    uint8_t* out = record;
+    *out++ = END_TAG;
+    out = putVarint(out, highway.getTick() - lastTick);
+    out = putValue(out, highway.stateHash());
+    send(record, out - record);
+    finish();
+}
+
+ReplayReader::ReplayReader()
+    : seed(0), bodyOffset(0), endTick(0), complete(false), finalHash(0),
+    cursor(0), cursorTick(0), steering(0) {
+}
+
+bool ReplayReader::readRecord(size_t& offset, unsigned long long previousTick, Record& record) const {
+    const uint8_t* in = file.data() + offset;
+    const uint8_t* end = file.data() + file.size();
+    if (in == end) return false;
+
+    record.tag = *in++;
+    unsigned long long value = 0;
+    int8_t direction = 0;
+    switch (record.tag) {
+    case INPUT_TAG:
+        if (!getVarint(in, end, value) || !getValue(in, end, direction)) return false;
+        record.tick = previousTick + value;
+        record.steering = direction;
+        break;
+    case KEYFRAME_TAG:
+        if (!getVarint(in, end, record.tick) || !getValue(in, end, direction) ||
+            !getVarint(in, end, value) || (size_t)(end - in) < value) {
+            return false;
+        }
+        record.steering = direction;
+        record.state = in;
+        record.stateSize = (size_t)value;
+        in += value;
+        break;
+    case END_TAG:
+        if (!getVarint(in, end, value) || !getValue(in, end, record.hash)) return false;
+        record.tick = previousTick + value;
+        break;
+    default:
+        return false;
+    }
+    offset = in - file.data();
+    return true;
+}
+
+bool ReplayReader::open(const char* path) {
+    if (!file.open(path)) return false;
+
+    const uint8_t* in = file.data();
+    const uint8_t* end = in + file.size();
+    uint8_t version = 0;
+    int32_t obstacleCount = 0, coinCount = 0, tickRate = 0, coinsForLevelUp = 0;
+    uint32_t interval = 0;
+    if (file.size() < sizeof(MAGIC) || memcmp(in, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << "Not a replay file: " << path << "\n";
+        return false;
+    }
+    in += sizeof(MAGIC);
+    if (!getValue(in, end, version) || version != VERSION ||
+        !getValue(in, end, seed) ||
+        !getValue(in, end, obstacleCount) ||
+        !getValue(in, end, coinCount) ||
+        !getValue(in, end, tickRate) ||
+        !getValue(in, end, coinsForLevelUp) ||
+        !getValue(in, end, config.levelSpeedMultiplier) ||
+        !getValue(in, end, config.rowSpacing) ||
+        !getValue(in, end, interval)) {
+        std::cerr << "Unsupported or damaged replay header: " << path << "\n";
+        return false;
+    }
+    if (obstacleCount < 0 || obstacleCount > MAX_ENTITIES ||
+        coinCount < 0 || coinCount > MAX_ENTITIES || tickRate <= 0 || !(config.rowSpacing >= 0)) {
+        std::cerr << "Invalid replay configuration: " << path << "\n";
+        return false;
+    }
+    config.obstacleCount = obstacleCount;
+    config.coinCount = coinCount;
+    config.tickRate = tickRate;
+    config.coinsForLevelUp = coinsForLevelUp;
+    bodyOffset = in - file.data();
+
+    // One pass over the records (no simulation) finds the keyframes and the
+    // end; a file cut short by a crash simply stops at its last whole record
+    keyframes.clear();
+    complete = false;
+    size_t offset = bodyOffset;
+    unsigned long long tick = 0;
+    Record record;
+    for (size_t start = offset; readRecord(offset, tick, record); start = offset) {
+        tick = record.tick;
+        if (record.tag == KEYFRAME_TAG) {
+            keyframes.push_back({ record.tick, start });
+        }
+        else if (record.tag == END_TAG) {
+            complete = true;
+            finalHash = record.hash;
+            break;
+        }
+    }
+    endTick = tick;
+    if (!complete) {
+        std::cerr << "Replay " << path << " has no end record; playable up to tick " << endTick << "\n";
+    }
+
+    return !keyframes.empty();
+}
+
+bool ReplayReader::seek(Highway& highway, Player& player, unsigned long long tick) {
+    if (keyframes.empty()) return false;
+    tick = std::min(tick, endTick);
+
+    // Last keyframe at or before tick
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), tick,
+        [](unsigned long long t, const Keyframe& keyframe) { return t < keyframe.tick; });
+    if (it != keyframes.begin()) --it;
+
+    size_t offset = it->offset;
+    Record record;
+    if (!readRecord(offset, 0, record) || !highway.restoreSnapshot(record.state, record.stateSize)) {
+        std::cerr << "Damaged replay keyframe at tick " << it->tick << "\n";
+        return false;
+    }
+    cursor = offset;
+    cursorTick = record.tick;
+    steering = record.steering;
+
+    playTo(highway, player, tick);
+    return true;
+}
+
+int ReplayReader::steeringAt(unsigned long long tick) {
+    // Consume every record up to and including tick
+    Record record;
+    size_t offset = cursor;
+    while (readRecord(offset, cursorTick, record) && record.tick <= tick && record.tag != END_TAG) {
+        steering = record.steering;
+        cursor = offset;
+        cursorTick = record.tick;
+    }
+    return steering;
+}
+
+void ReplayReader::playTo(Highway& highway, Player& player, unsigned long long tick) {
+    tick = std::min(tick, endTick);
+    while (highway.getTick() < tick && !highway.isGameOver) {
+        player.steer(steeringAt(highway.getTick()), highway.getStepScale());
+        player.update();
+        highway.update();
+        highway.checkCollisions();
+    }
+}
\ No newline at end of file
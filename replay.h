@@ -0,0 +1,156 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "highway.h"
+#include "mappedfile.h"
+
+class Player;
+
+// Replay files record a session in tick space: the seed and HighwayConfig,
+// the steering input whenever it changes, and a full Highway snapshot as a
+// keyframe every ReplayWriter::KEYFRAME_INTERVAL ticks. Because the simulation is deterministic,
+// that is enough to rebuild any tick exactly. Pausing never changes the
+// tick stream, so pauses are not recorded.
+//
+// Layout (little-endian):
+//   header   "TRRP", u8 version, u64 seed, i32 obstacleCount, i32 coinCount,
+//            i32 tickRate, i32 coinsForLevelUp, f32 levelSpeedMultiplier,
+//            f32 rowSpacing, u32 keyframe interval
+//   records  u8 tag, then
+//            INPUT:    varint ticks since the previous record, i8 steering
+//            KEYFRAME: varint absolute tick, i8 steering, varint size, state
+//            END:      varint ticks since the previous record, u64 state hash
+// An input record at tick t applies from the step that leaves tick t on.
+// The tick thread only copies records into a ring; a writer thread writes
+// and flushes them, so a session that crashed is still readable up to the
+// records that left the rewind window.
+class ReplayWriter {
+public:
+    static const uint32_t KEYFRAME_INTERVAL = 1200; // 15 s at 80 ticks per second
+
+    ReplayWriter();
+    ~ReplayWriter();
+
+    // Starts a file for a highway that was just created or reset with seed
+    bool open(const char* path, uint64_t seed, const Highway& highway);
+    // Call before simulating each tick with the steering about to be applied.
+    // Never allocates.
+    void recordTick(const Highway& highway, int steering);
+    // Writes the end record (final tick and state hash) and closes the file
+    void close(const Highway& highway);
+
+    // Set before open() when the session can rewind (see RewindBuffer):
+    // records stay in memory for this many ticks before they reach the file,
+    // so that rewind() can still take them back
+    void setRewindWindow(unsigned ticks) { rewindWindow = ticks; }
+    // Call after highway was restored to an earlier tick within the window.
+    // Forgets everything recorded after that tick, so the file holds the
+    // timeline the player kept.
+    void rewind(const Highway& highway);
+
+    bool isOpen() const { return file != nullptr; }
+
+private:
+    // A record held back for rewinding, and the writer state before it
+    struct Mark {
+        unsigned long long tick;
+        size_t offset; // In pending
+        unsigned long long lastTick;
+        int lastSteering;
+    };
+
+    FILE* file;
+    unsigned long long lastTick; // Tick of the previous record
+    int lastSteering;
+    unsigned rewindWindow;
+    std::vector<uint8_t> buffer;   // Serialized keyframe scratch
+    std::vector<uint8_t> pending;  // Held-back records, oldest first
+    std::vector<Mark> marks;       // One per held-back record
+
+    // Committed bytes on their way to the file. queuedStart and queuedEnd
+    // count bytes since open() and only grow; the writer thread owns
+    // [queuedStart, queuedEnd) of the ring until it moves queuedStart.
+    std::vector<uint8_t> outgoing;
+    size_t queuedStart;
+    size_t queuedEnd;
+    bool stopping;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable bytesQueued;
+    std::condition_variable spaceFree;
+
+    void writeKeyframe(const Highway& highway, int steering);
+    void emit(const uint8_t* bytes, size_t size, unsigned long long tick);
+    void commit(size_t count); // Sends the oldest count held-back records
+    void send(const uint8_t* bytes, size_t size);
+    void writerLoop();
+    void finish(); // Drains the ring, stops the writer and closes the file
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+};
+
+// Plays a memory-mapped replay file. seek() jumps to any tick by restoring
+// the nearest keyframe and simulating at most one keyframe interval.
+class ReplayReader {
+public:
+    ReplayReader();
+
+    bool open(const char* path);
+
+    uint64_t getSeed() const { return seed; }
+    const HighwayConfig& getConfig() const { return config; }
+    unsigned long long getEndTick() const { return endTick; } // Last recorded tick
+    bool isComplete() const { return complete; }               // Has an end record
+    uint64_t getFinalHash() const { return finalHash; }         // Only if complete
+    size_t getKeyframeCount() const { return keyframes.size(); }
+
+    // Puts highway (built from getSeed() and getConfig()) at tick, or at the
+    // last recorded tick if tick is past it. Returns false if the replay has
+    // no keyframe to start from.
+    bool seek(Highway& highway, Player& player, unsigned long long tick);
+    // Steering for the step leaving tick; call in tick order after seek()
+    int steeringAt(unsigned long long tick);
+    // Simulates from the highway's current tick up to tick (or a crash)
+    void playTo(Highway& highway, Player& player, unsigned long long tick);
+
+private:
+    struct Record {
+        uint8_t tag;
+        unsigned long long tick;
+        int steering;
+        const uint8_t* state;
+        size_t stateSize;
+        uint64_t hash;
+    };
+
+    struct Keyframe {
+        unsigned long long tick;
+        size_t offset; // Of the record
+    };
+
+    MappedFile file;
+    uint64_t seed;
+    HighwayConfig config;
+    size_t bodyOffset;
+    std::vector<Keyframe> keyframes;
+    unsigned long long endTick;
+    bool complete;
+    uint64_t finalHash;
+
+    // Playback cursor
+    size_t cursor;
+    unsigned long long cursorTick; // Tick of the last record consumed
+    int steering;
+
+    bool readRecord(size_t& offset, unsigned long long previousTick, Record& record) const;
+};
+
+#endif // REPLAY_H
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include "rewind.h"
+#include "highway.h"
+
+RewindBuffer::RewindBuffer(const Highway& highway, size_t capacity)
+    : storage(highway.getSnapshotCapacity() * capacity), slotSize(highway.getSnapshotCapacity()),
+    capacity(capacity), newest(capacity - 1), count(0) {
+}
+
+void RewindBuffer::push(const Highway& highway) {
+    if (capacity == 0) return;
+    newest = (newest + 1) % capacity;
+    highway.saveSnapshot(slot(newest));
+    if (count < capacity) count++;
+}
+
+bool RewindBuffer::pop(Highway& highway) {
+    if (count == 0) return false;
+    bool restored = highway.restoreSnapshot(slot(newest), slotSize);
+    newest = (newest + capacity - 1) % capacity;
+    count--;
+    return restored;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Highway;
+
+// Ring of the most recent Highway snapshots, one per tick, for rewinding.
+// All slots live in one flat block sized at construction, so push() and
+// pop() are a snapshot copy each and never allocate.
+class RewindBuffer {
+public:
+    RewindBuffer(const Highway& highway, size_t capacity);
+
+    void push(const Highway& highway); // Save the current tick, dropping the oldest when full
+    bool pop(Highway& highway);        // Restore the newest saved tick; false when empty
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+
+private:
+    std::vector<uint8_t> storage;
+    size_t slotSize;
+    size_t capacity;
+    size_t newest; // Slot of the last push
+    size_t count;
+
+    uint8_t* slot(size_t index) { return storage.data() + index * slotSize; }
+};
+
+#endif // REWIND_H
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// Small, fast xoshiro128** generator. Each Highway owns one so a run is fully
+// determined by its seed and the player's inputs.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        // Expand the seed with splitmix64 so that nearby seeds diverge quickly
+        for (int i = 0; i < 4; i += 2) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            state[i] = static_cast<uint32_t>(z);
+            state[i + 1] = static_cast<uint32_t>(z >> 32);
+        }
+    }
+
+    uint32_t next() {
+        uint32_t result = rotl(state[1] * 5, 7) * 9;
+        uint32_t t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 11);
+        return result;
+    }
+
+    // Raw generator state, for saving and restoring a run mid-way
+    void getState(uint32_t out[4]) const {
+        for (int i = 0; i < 4; i++) out[i] = state[i];
+    }
+    void setState(const uint32_t in[4]) {
+        for (int i = 0; i < 4; i++) state[i] = in[i];
+    }
+
+    // Uniform integer in [0, bound)
+    int nextInt(int bound) {
+        return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint32_t>(bound)) >> 32);
+    }
+
+private:
+    uint32_t state[4];
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
+
+#endif // RNG_H
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "simthread.h"
+#include "environment.h"
+#include "framepacer.h"
+#include "highway.h"
+#include "profiler.h"
+#include "replay.h"
+#include "soundeffects.h"
+#include <iostream>
+
+SimulationThread::SimulationThread(Player& player, Highway& highway, Profiler& profiler,
+    FramePacer& pacer)
+    : player(player), highway(highway), profiler(profiler), pacer(pacer),
+    recorder(nullptr), playback(nullptr), sounds(nullptr), timer(nullptr), queue(nullptr),
+    history(highway, (size_t)REWIND_SECONDS * highway.getConfig().tickRate),
+    steering(0), paused(false), rewinding(false), stopping(false),
+    previousLevel(highway.getLevel()), previousCoins(highway.coinCollected), levelUpTicks(0) {
+    // Size every slot up front so publishing never allocates
+    for (int i = 0; i < 3; i++) {
+        snapshots.slot(i).reserve(highway);
+    }
+}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+bool SimulationThread::start(ALLEGRO_TIMER* tickTimer) {
+    queue = al_create_event_queue();
+    if (!queue) {
+        std::cerr << "Failed to create simulation event queue!\n";
+        return false;
+    }
+    timer = tickTimer;
+    al_set_timer_speed(timer, highway.getStepScale() / FPS);
+    al_register_event_source(queue, al_get_timer_event_source(timer));
+
+    // The render thread always has a snapshot to draw
+    previousLevel = highway.getLevel(); // A replay may start mid-run
+    previousCoins = highway.coinCollected;
+    snapshots.writeSlot().capturePrevious(highway);
+    publish(al_get_time());
+    stopping = false;
+    thread = std::thread(&SimulationThread::run, this);
+    al_start_timer(timer);
+    return true;
+}
+
+void SimulationThread::stop() {
+    if (!thread.joinable()) return;
+    stopping = true;
+    thread.join();
+    al_stop_timer(timer);
+    al_destroy_event_queue(queue);
+    queue = nullptr;
+}
+
+void SimulationThread::run() {
+    while (!stopping && !highway.isGameOver) {
+        // Wake up periodically so stop() is noticed even if the timer stalls
+        ALLEGRO_EVENT event;
+        if (!al_wait_for_event_timed(queue, &event, 0.1f)) continue;
+        if (event.type != ALLEGRO_EVENT_TIMER) continue;
+
+        // Coalesce every tick that came due while this thread was held up
+        int due = 1;
+        double time = event.any.timestamp;
+        while (al_get_next_event(queue, &event)) {
+            if (event.type == ALLEGRO_EVENT_TIMER) {
+                due++;
+                time = event.any.timestamp;
+            }
+        }
+        if (paused.load(std::memory_order_relaxed)) continue;
+        if (playback && highway.getTick() >= playback->getEndTick()) continue;
+
+        // Run what the pacer allows; the renderer blends across the last one
+        int run = pacer.admitTicks(due);
+        if (rewinding.load(std::memory_order_relaxed) && !playback) {
+            rewind(run * REWIND_SPEED);
+            publish(time);
+            continue;
+        }
+        for (int i = 0; i < run && !highway.isGameOver; i++) {
+            int direction = playback ? playback->steeringAt(highway.getTick())
+                : steering.load(std::memory_order_relaxed);
+            if (recorder) recorder->recordTick(highway, direction);
+            history.push(highway);
+
+            snapshots.writeSlot().capturePrevious(highway);
+            tick(direction);
+        }
+        publish(time);
+    }
+}
+
+void SimulationThread::tick(int direction) {
+    const float step = highway.getStepScale();
+    player.steer(direction, step);
+
+    profiler.countTick();
+    {
+        ProfileScope scope(profiler, Profiler::PLAYER_UPDATE);
+        player.update();
+    }
+    {
+        ProfileScope scope(profiler, Profiler::HIGHWAY_UPDATE);
+        highway.update();
+    }
+    {
+        ProfileScope scope(profiler, Profiler::COLLISIONS);
+        highway.checkCollisions();
+    }
+
+    // Sound cues only queue; the render thread plays them
+    if (sounds) {
+        for (int i = previousCoins; i < highway.coinCollected; i++) {
+            sounds->trigger(SoundEffects::COIN);
+        }
+        if (highway.getLevel() > previousLevel) sounds->trigger(SoundEffects::LEVEL_UP);
+        if (highway.isGameOver) sounds->trigger(SoundEffects::CRASH);
+    }
+    previousCoins = highway.coinCollected;
+
+    // Check if level has changed
+    if (highway.getLevel() > previousLevel) {
+        levelUpTicks = (int)(180 / step); // Show for 180 FPS-rate ticks
+        previousLevel = highway.getLevel();
+    }
+
+    // Update level up notification timer
+    if (levelUpTicks > 0) {
+        levelUpTicks--;
+    }
+}
+
+void SimulationThread::rewind(int ticks) {
+    bool moved = false;
+    for (int i = 0; i < ticks && history.pop(highway); i++) {
+        moved = true;
+    }
+
+    // Going backwards is shown tick by tick rather than blended: respawns
+    // and the background seam only make sense in the forward direction
+    snapshots.writeSlot().capturePrevious(highway);
+    if (!moved) return;
+
+    if (recorder) recorder->rewind(highway);
+    previousLevel = highway.getLevel();
+    previousCoins = highway.coinCollected;
+    levelUpTicks = 0;
+}
+
+void SimulationThread::publish(double time) {
+    WorldSnapshot& snapshot = snapshots.writeSlot();
+    snapshot.capture(highway);
+    snapshot.time = time;
+    snapshot.levelUpTicks = levelUpTicks;
+    snapshots.publish();
+}
\ No newline at end of file
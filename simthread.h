@@ -0,0 +1,99 @@
+#ifndef SIMTHREAD_H
+#define SIMTHREAD_H
+
+#include <allegro5/allegro.h>
+#include <atomic>
+#include <thread>
+#include "rewind.h"
+#include "snapshot.h"
+#include "triplebuffer.h"
+
+class FramePacer;
+class Highway;
+class Player;
+class Profiler;
+class ReplayReader;
+class ReplayWriter;
+class SoundEffects;
+
+// Runs the Player/Highway simulation on its own thread, one tick per event of
+// a dedicated timer, so rendering and flipping never delay a tick. Every tick
+// is published as a WorldSnapshot through a triple buffer; the render thread
+// reads the newest one whenever it draws a frame. Ticks that pile up while
+// the thread is held up are coalesced and rationed by a FramePacer.
+//
+// Once started, the player and highway belong to the simulation thread until
+// stop(). Input crosses over through atomics, or comes from a replay.
+//
+// Every tick is also saved into a RewindBuffer; while rewinding is held the
+// thread walks back through it REWIND_SPEED ticks per tick instead.
+class SimulationThread {
+public:
+    static const int REWIND_SECONDS = 5; // How far back rewinding can go
+    static const int REWIND_SPEED = 2;   // Ticks undone per tick of rewinding
+
+    SimulationThread(Player& player, Highway& highway, Profiler& profiler, FramePacer& pacer);
+    ~SimulationThread();
+
+    // Publishes the initial state and starts ticking on timer at the
+    // highway's tick rate. The timer must not be registered with any other
+    // queue.
+    bool start(ALLEGRO_TIMER* timer);
+    void stop(); // Stops ticking and joins the thread
+
+    // Optional, before start(): record every tick's input, or take the
+    // input from a replay (positioned with ReplayReader::seek) instead of
+    // setSteering() and stop ticking where the recording ends
+    void setRecorder(ReplayWriter* writer) { recorder = writer; }
+    void setPlayback(ReplayReader* reader) { playback = reader; }
+    // Optional, before start(): coin, level-up and crash sounds are
+    // triggered from the tick that causes them
+    void setSoundEffects(SoundEffects* effects) { sounds = effects; }
+
+    // Input, safe to call from any thread
+    void setSteering(int direction) { steering.store(direction, std::memory_order_relaxed); }
+    void setPaused(bool value) { paused.store(value, std::memory_order_relaxed); }
+    void setRewinding(bool value) { rewinding.store(value, std::memory_order_relaxed); }
+
+    // Ticks of history kept for rewinding; pass to ReplayWriter::setRewindWindow
+    unsigned getRewindTicks() const { return (unsigned)history.getCapacity(); }
+
+    // Render side: swaps in the newest snapshot, returning whether it changed.
+    // The result of latest() stays valid until the next call to acquire().
+    bool acquire() { return snapshots.update(); }
+    const WorldSnapshot& latest() const { return snapshots.read(); }
+
+private:
+    Player& player;
+    Highway& highway;
+    Profiler& profiler;
+    FramePacer& pacer;
+    ReplayWriter* recorder;
+    ReplayReader* playback;
+    SoundEffects* sounds;
+    ALLEGRO_TIMER* timer;
+    ALLEGRO_EVENT_QUEUE* queue;
+    std::thread thread;
+    TripleBuffer<WorldSnapshot> snapshots;
+    RewindBuffer history; // Owned by the simulation thread
+
+    std::atomic<int> steering; // -1 left, 0 none, 1 right
+    std::atomic<bool> paused;
+    std::atomic<bool> rewinding;
+    std::atomic<bool> stopping;
+
+    // Level-up banner and sound cues, owned by the simulation thread
+    int previousLevel;
+    int previousCoins;
+    int levelUpTicks;
+
+    void run();
+    void tick(int direction);
+    void rewind(int ticks);
+    void publish(double time);
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+};
+
+#endif // SIMTHREAD_H
\ No newline at end of file
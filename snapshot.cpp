@@ -0,0 +1,44 @@
+#include "snapshot.h"
+#include "environment.h"
+
+void WorldSnapshot::reserve(const Highway& highway) {
+    obstacles.x.reserve(highway.getObstacles().x.capacity());
+    obstacles.y.reserve(highway.getObstacles().y.capacity());
+    obstacles.carType.reserve(highway.getObstacles().carType.capacity());
+    coins.x.reserve(highway.getCoins().x.capacity());
+    coins.y.reserve(highway.getCoins().y.capacity());
+    coins.collected.reserve(highway.getCoins().collected.capacity());
+    previousObstacleY.reserve(highway.getObstacles().y.capacity());
+    previousCoinY.reserve(highway.getCoins().y.capacity());
+}
+
+void WorldSnapshot::capturePrevious(const Highway& highway) {
+    previousObstacleY = highway.getObstacles().y;
+    previousCoinY = highway.getCoins().y;
+    previousPlayerX = highway.getPlayer().x;
+    previousBackgroundY = highway.getBackgroundY();
+}
+
+void WorldSnapshot::capture(const Highway& highway) {
+    // Assignment reuses the reserved storage
+    const ObstacleArray& sourceObstacles = highway.getObstacles();
+    obstacles.x = sourceObstacles.x;
+    obstacles.y = sourceObstacles.y;
+    obstacles.carType = sourceObstacles.carType;
+
+    const CoinArray& sourceCoins = highway.getCoins();
+    coins.x = sourceCoins.x;
+    coins.y = sourceCoins.y;
+    coins.collected = sourceCoins.collected;
+
+    const Player& player = highway.getPlayer();
+    tick = highway.getTick();
+    playerX = player.x;
+    playerY = player.y;
+    backgroundY = highway.getBackgroundY();
+    score = highway.getScore();
+    level = highway.getLevel();
+    coinCollected = highway.coinCollected;
+    coinTarget = highway.getCoinTarget();
+    isGameOver = highway.isGameOver;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "coin.h"
+#include "highway.h"
+
+// Copy of everything the render thread needs from one simulation tick. The
+// simulation thread fills one and publishes it; once published it is never
+// written again, so drawing from it needs no locking.
+//
+// The moving values are also kept as they were before the tick, so the
+// renderer can interpolate between the two at any display rate.
+struct WorldSnapshot {
+    unsigned long long tick = 0;
+    double time = 0; // When the tick was due, on the al_get_time() clock
+    ObstacleArray obstacles; // Positions and sprite types only (no speeds)
+    CoinArray coins;         // Positions and collected flags only
+    float playerX = 0, playerY = 0;
+    float backgroundY = 0;
+    int score = 0;
+    int level = 1;
+    int coinCollected = 0;
+    int coinTarget = 0; // Coins that reach the next level; 0 on the last
+    int levelUpTicks = 0; // Ticks left on the level-up banner
+    bool isGameOver = false;
+
+    // State before the tick; entities keep their index across a tick
+    std::vector<float> previousObstacleY, previousCoinY;
+    float previousPlayerX = 0;
+    float previousBackgroundY = 0;
+
+    // Sizes the arrays for the highway's pools so capturing never allocates
+    void reserve(const Highway& highway);
+    void capturePrevious(const Highway& highway); // Call before stepping
+    void capture(const Highway& highway);         // Call after stepping
+};
+
+#endif // SNAPSHOT_H
\ No newline at end of file
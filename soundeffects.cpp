@@ -0,0 +1,196 @@
+#include "soundeffects.h"
+#include "rng.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+const float TWO_PI = 6.2831853f;
+
+// Appends a note with a short attack and a linear fade to silence. square
+// gives the bright chiptune timbre, otherwise a soft sine with a little
+// second harmonic.
+static void appendTone(std::vector<float>& pcm, float frequency, float seconds, float volume,
+    bool square) {
+    const int count = (int)(seconds * SoundEffects::SAMPLE_RATE);
+    const int attack = SoundEffects::SAMPLE_RATE / 200; // 5 ms, avoids a click
+    for (int i = 0; i < count; i++) {
+        float phase = TWO_PI * frequency * i / SoundEffects::SAMPLE_RATE;
+        float wave = square ? (std::sin(phase) >= 0 ? 1.0f : -1.0f)
+            : 0.8f * std::sin(phase) + 0.2f * std::sin(2 * phase);
+        float envelope = std::min(1.0f, (float)i / attack) * (1.0f - (float)i / count);
+        pcm.push_back(volume * wave * envelope);
+    }
+}
+
+// Two quick rising notes
+static void synthesizeCoin(std::vector<float>& pcm) {
+    appendTone(pcm, 987.77f, 0.06f, 0.25f, true);  // B5
+    appendTone(pcm, 1318.51f, 0.18f, 0.25f, true); // E6
+}
+
+// Major arpeggio up to the octave
+static void synthesizeLevelUp(std::vector<float>& pcm) {
+    const float notes[] = { 523.25f, 659.25f, 783.99f }; // C5 E5 G5
+    for (float note : notes) {
+        appendTone(pcm, note, 0.09f, 0.5f, false);
+    }
+    appendTone(pcm, 1046.50f, 0.35f, 0.5f, false); // C6
+}
+
+// Noise burst closing down to a rumble, over a falling thud
+static void synthesizeCrash(std::vector<float>& pcm) {
+    const int count = (int)(0.7f * SoundEffects::SAMPLE_RATE);
+    Rng rng(0xC7A5u); // Fixed, so the clip is the same every run
+    float filtered = 0;
+    for (int i = 0; i < count; i++) {
+        float t = (float)i / SoundEffects::SAMPLE_RATE;
+        float noise = rng.next() / 2147483648.0f - 1.0f;
+        // One-pole low-pass whose cutoff falls as the crash dies away
+        float cutoff = 0.5f * std::exp(-6 * t) + 0.02f;
+        filtered += cutoff * (noise - filtered);
+        float thud = std::sin(TWO_PI * (90 - 40 * t) * t) * std::exp(-8 * t);
+        pcm.push_back((0.8f * filtered + 0.5f * thud) * std::exp(-4 * t));
+    }
+}
+
+SoundEffects::SoundEffects() : overflowed(0), playCount(0), ready(false), muted(false) {
+    for (Clip& clip : clips) {
+        clip.sample = nullptr;
+        clip.priority = 0;
+        clip.gain = 1;
+    }
+    for (Voice& voice : voices) {
+        voice.instance = nullptr;
+        voice.priority = 0;
+        voice.started = 0;
+    }
+}
+
+SoundEffects::~SoundEffects() {
+    release();
+}
+
+bool SoundEffects::init() {
+    ALLEGRO_MIXER* mixer = al_get_default_mixer();
+    if (!mixer) {
+        std::cerr << "No audio mixer; sound effects are off\n";
+        return false;
+    }
+
+    // A crash is never cut off by a coin
+    synthesizeCoin(clips[COIN].pcm);
+    clips[COIN].priority = 1;
+    clips[COIN].gain = 0.6f;
+    synthesizeLevelUp(clips[LEVEL_UP].pcm);
+    clips[LEVEL_UP].priority = 2;
+    clips[LEVEL_UP].gain = 0.8f;
+    synthesizeCrash(clips[CRASH].pcm);
+    clips[CRASH].priority = 3;
+    clips[CRASH].gain = 1.0f;
+
+    for (Clip& clip : clips) {
+        clip.sample = al_create_sample(clip.pcm.data(), (unsigned)clip.pcm.size(), SAMPLE_RATE,
+            ALLEGRO_AUDIO_DEPTH_FLOAT32, ALLEGRO_CHANNEL_CONF_1, false);
+        if (!clip.sample) {
+            std::cerr << "Failed to create sound effect clips!\n";
+            release();
+            return false;
+        }
+    }
+
+    // Every clip has the same format, so a voice switching clips never has
+    // to be reattached to the mixer
+    for (Voice& voice : voices) {
+        voice.instance = al_create_sample_instance(clips[COIN].sample);
+        if (!voice.instance || !al_attach_sample_instance_to_mixer(voice.instance, mixer)) {
+            std::cerr << "Failed to create sound effect voices!\n";
+            release();
+            return false;
+        }
+        al_set_sample_instance_playmode(voice.instance, ALLEGRO_PLAYMODE_ONCE);
+    }
+    ready = true;
+    return true;
+}
+
+void SoundEffects::release() {
+    ready = false;
+    for (Voice& voice : voices) {
+        if (voice.instance) al_destroy_sample_instance(voice.instance);
+        voice.instance = nullptr;
+    }
+    for (Clip& clip : clips) {
+        if (clip.sample) al_destroy_sample(clip.sample);
+        clip.sample = nullptr;
+    }
+}
+
+void SoundEffects::trigger(Effect effect) {
+    if (!pending.push((uint8_t)effect)) {
+        overflowed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SoundEffects::update() {
+    uint8_t effect;
+    while (pending.pop(effect)) {
+        if (ready && !muted) play((Effect)effect);
+    }
+}
+
+void SoundEffects::play(Effect effect) {
+    const Clip& clip = clips[effect];
+
+    // A free voice, otherwise the least important one (the oldest among
+    // equals) as long as it does not outrank the new effect
+    Voice* chosen = nullptr;
+    bool stealing = false;
+    for (Voice& voice : voices) {
+        if (!al_get_sample_instance_playing(voice.instance)) {
+            chosen = &voice;
+            stealing = false;
+            break;
+        }
+        if (voice.priority > clip.priority) continue;
+        if (!chosen || voice.priority < chosen->priority ||
+            (voice.priority == chosen->priority && voice.started < chosen->started)) {
+            chosen = &voice;
+            stealing = true;
+        }
+    }
+    if (!chosen) {
+        counters.dropped++;
+        return;
+    }
+    if (stealing) counters.stolen++;
+
+    // Switching the clip stops the voice first
+    al_set_sample(chosen->instance, clip.sample);
+    al_set_sample_instance_gain(chosen->instance, clip.gain);
+    al_play_sample_instance(chosen->instance);
+    chosen->priority = clip.priority;
+    chosen->started = ++playCount;
+    counters.played[effect]++;
+}
+
+void SoundEffects::setMuted(bool value) {
+    muted = value;
+    if (!muted || !ready) return;
+    for (Voice& voice : voices) {
+        al_stop_sample_instance(voice.instance);
+    }
+}
+
+SoundEffects::Counters SoundEffects::getCounters() const {
+    Counters result = counters;
+    result.overflowed = overflowed.load(std::memory_order_relaxed);
+    return result;
+}
+
+void SoundEffects::printStats() const {
+    Counters stats = getCounters();
+    std::cout << "Sound effects: " << stats.played[COIN] << " coin, " << stats.played[LEVEL_UP]
+        << " level-up, " << stats.played[CRASH] << " crash played; " << stats.stolen
+        << " voices stolen, " << stats.dropped << " dropped, " << stats.overflowed
+        << " lost to a full queue\n";
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef SOUNDEFFECTS_H
+#define SOUNDEFFECTS_H
+
+#include <allegro5/allegro_audio.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "spscqueue.h"
+
+// Short game sounds played on a fixed pool of voices. Every clip is
+// synthesized and decoded to PCM once at startup, and every voice is created
+// up front, so playing one only points a voice at a clip.
+//
+// Effects are triggered from the simulation thread through a lock-free
+// queue and started on the thread that owns the audio (the render thread)
+// in update(). When every voice is busy, the voice playing the lowest
+// priority clip (the oldest among equals) is stolen if it is not more
+// important than the new effect; otherwise the new effect is dropped.
+class SoundEffects {
+public:
+    enum Effect {
+        COIN,
+        LEVEL_UP,
+        CRASH,
+        EFFECT_COUNT
+    };
+
+    static const int VOICES = 8;
+    static const int SAMPLE_RATE = 44100;
+
+    struct Counters {
+        unsigned long played[EFFECT_COUNT] = {};
+        unsigned long stolen = 0;     // Voices cut off for a more important effect
+        unsigned long dropped = 0;    // Effects that found no voice they could take
+        unsigned long overflowed = 0; // Triggers lost to a full queue
+    };
+
+    SoundEffects();
+    ~SoundEffects();
+
+    // Builds the clips and voices on the default mixer. Returns false (and
+    // every later call does nothing) if audio is unavailable.
+    bool init();
+
+    // Simulation thread: queues effect for the next update(). Never
+    // allocates or waits. Only one thread may trigger.
+    void trigger(Effect effect);
+    // Audio thread: starts every queued effect
+    void update();
+
+    // Effects triggered while muted are discarded; playing ones are cut
+    void setMuted(bool value);
+
+    Counters getCounters() const;
+    void printStats() const;
+
+private:
+    struct Clip {
+        std::vector<float> pcm; // Mono, SAMPLE_RATE, owned here rather than by the sample
+        ALLEGRO_SAMPLE* sample;
+        int priority;
+        float gain;
+    };
+
+    struct Voice {
+        ALLEGRO_SAMPLE_INSTANCE* instance;
+        int priority;         // Of the clip it is playing
+        unsigned long started; // Order of play, for stealing the oldest
+    };
+
+    Clip clips[EFFECT_COUNT];
+    Voice voices[VOICES];
+    SpscQueue<uint8_t, 64> pending;
+    std::atomic<unsigned long> overflowed; // Counted by the triggering thread
+    unsigned long playCount;
+    bool ready;
+    bool muted;
+    Counters counters;
+
+    SoundEffects(const SoundEffects&) = delete;
+    SoundEffects& operator=(const SoundEffects&) = delete;
+
+    void play(Effect effect);
+    void release();
+};
+
+#endif // SOUNDEFFECTS_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "spriteatlas.h"
+#include <algorithm>
+#include <iostream>
+
+SpriteAtlas::SpriteAtlas() : bitmap(nullptr) {
+}
+
+SpriteAtlas::~SpriteAtlas() {
+    clear();
+}
+
+int SpriteAtlas::add(ALLEGRO_BITMAP* source) {
+    Region region;
+    region.source = source;
+    region.sprite = source;
+    region.x = region.y = 0;
+    regions.push_back(region);
+    return static_cast<int>(regions.size()) - 1;
+}
+
+bool SpriteAtlas::build() {
+    // Shelf packing, tallest sprites first so every shelf wastes little height
+    std::vector<int> order;
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (regions[i].source) order.push_back(static_cast<int>(i));
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return al_get_bitmap_height(regions[a].source) > al_get_bitmap_height(regions[b].source);
+    });
+
+    int shelfX = 0, shelfY = 0, shelfHeight = 0, atlasWidth = 0;
+    for (int id : order) {
+        Region& region = regions[id];
+        int width = al_get_bitmap_width(region.source) + PADDING;
+        int height = al_get_bitmap_height(region.source) + PADDING;
+        if (shelfX > 0 && shelfX + width > MAX_WIDTH) {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        region.x = shelfX;
+        region.y = shelfY;
+        shelfX += width;
+        shelfHeight = std::max(shelfHeight, height);
+        atlasWidth = std::max(atlasWidth, shelfX);
+    }
+    int atlasHeight = shelfY + shelfHeight;
+    if (order.empty()) return false;
+
+    bitmap = al_create_bitmap(atlasWidth, atlasHeight);
+    if (!bitmap) {
+        std::cerr << "Failed to create " << atlasWidth << "x" << atlasHeight
+            << " sprite atlas, drawing sprites individually\n";
+        return false;
+    }
+
+    // Copy the sources verbatim (no blending) into their slots
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_BLENDER);
+    al_set_target_bitmap(bitmap);
+    al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+    al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+    for (int id : order) {
+        al_draw_bitmap(regions[id].source, regions[id].x, regions[id].y, 0);
+    }
+    al_restore_state(&state);
+
+    for (int id : order) {
+        Region& region = regions[id];
+        ALLEGRO_BITMAP* sprite = al_create_sub_bitmap(bitmap, region.x, region.y,
+            al_get_bitmap_width(region.source), al_get_bitmap_height(region.source));
+        if (sprite) region.sprite = sprite;
+    }
+    return true;
+}
+
+void SpriteAtlas::clear() {
+    // Sub-bitmaps must go before their parent
+    for (Region& region : regions) {
+        if (region.sprite && region.sprite != region.source) {
+            al_destroy_bitmap(region.sprite);
+        }
+    }
+    regions.clear();
+    if (bitmap) {
+        al_destroy_bitmap(bitmap);
+        bitmap = nullptr;
+    }
+}
\ No newline at end of file
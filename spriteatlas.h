@@ -0,0 +1,46 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <allegro5/allegro.h>
+#include <vector>
+
+// Packs small sprites into one bitmap so that a whole pass of sprite draws
+// comes from a single texture and can be batched by al_hold_bitmap_drawing.
+// Sources are copied once by build(); each region is handed out as a
+// sub-bitmap of the atlas and drawn like any other bitmap.
+class SpriteAtlas {
+public:
+    static const int MAX_WIDTH = 512; // Shelves wrap at this width
+    static const int PADDING = 1;     // Transparent gutter between regions
+
+    SpriteAtlas();
+    ~SpriteAtlas();
+
+    // Queues source for packing and returns its region id. The source must
+    // stay alive until build(); a null source gives a null region.
+    int add(ALLEGRO_BITMAP* source);
+
+    // Packs every queued sprite into a new atlas bitmap. If the atlas cannot
+    // be created the regions fall back to the source bitmaps themselves, so
+    // drawing still works (unbatched) and false is returned.
+    bool build();
+
+    ALLEGRO_BITMAP* region(int id) const { return regions[id].sprite; }
+    ALLEGRO_BITMAP* getBitmap() const { return bitmap; }
+    void clear();
+
+private:
+    struct Region {
+        ALLEGRO_BITMAP* source;
+        ALLEGRO_BITMAP* sprite; // Sub-bitmap of the atlas, or the source
+        int x, y;
+    };
+
+    std::vector<Region> regions;
+    ALLEGRO_BITMAP* bitmap;
+
+    SpriteAtlas(const SpriteAtlas&) = delete;
+    SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+};
+
+#endif // SPRITEATLAS_H
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "spritecache.h"
+#include "assetloader.h"
+#include <allegro5/allegro_image.h>
+#include <algorithm>
+#include <iostream>
+
+SpriteCache& SpriteCache::instance() {
+    static SpriteCache cache;
+    return cache;
+}
+
+std::string SpriteCache::makeKey(const char* path, int width, int height, ScaleMode mode) {
+    std::string key(path);
+    if (width > 0 && height > 0) {
+        key += '@';
+        key += std::to_string(width);
+        key += 'x';
+        key += std::to_string(height);
+        if (mode == ScaleMode::Fit) key += "fit";
+    }
+    return key;
+}
+
+size_t SpriteCache::bitmapBytes(ALLEGRO_BITMAP* bitmap) {
+    if (!bitmap) return 0;
+    return static_cast<size_t>(al_get_bitmap_width(bitmap)) * al_get_bitmap_height(bitmap) *
+        al_get_pixel_size(al_get_bitmap_format(bitmap));
+}
+
+ALLEGRO_BITMAP* SpriteCache::acquire(const char* path, int width, int height,
+    ScaleMode mode, SpriteFallback fallback) {
+    std::string key = makeKey(path, width, height, mode);
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        stats.hits++;
+        it->second.refCount++;
+        return it->second.bitmap;
+    }
+
+    stats.misses++;
+    Entry entry;
+    if (width > 0 && height > 0) {
+        entry.bitmap = pack.create(key);
+        if (entry.bitmap) stats.packed++;
+    }
+    if (!entry.bitmap) {
+        entry.bitmap = load(path, width, height, mode, fallback);
+    }
+    entry.refCount = 1;
+    entry.bytes = bitmapBytes(entry.bitmap);
+
+    // Failed loads are cached too so a missing file is only probed once
+    stats.residentBytes += entry.bytes;
+    stats.residentCount++;
+    entries.emplace(key, entry);
+    return entry.bitmap;
+}
+
+ALLEGRO_BITMAP* SpriteCache::load(const char* path, int width, int height,
+    ScaleMode mode, SpriteFallback fallback) {
+    // Sources are loaded with linear filtering so the one-off resample is smooth;
+    // the final variants are drawn 1:1 and keep the caller's bitmap flags
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_NEW_BITMAP_PARAMETERS | ALLEGRO_STATE_TARGET_BITMAP |
+        ALLEGRO_STATE_BLENDER);
+    int plainFlags = al_get_new_bitmap_flags();
+    al_set_new_bitmap_flags(plainFlags | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR);
+
+    // Reuse an already decoded native image if there is one
+    ALLEGRO_BITMAP* source = nullptr;
+    bool ownsSource = false;
+    auto native = entries.find(path);
+    if (native != entries.end()) {
+        source = native->second.bitmap;
+    }
+    else {
+        // Prefer the copy the loader threads decoded in the background
+        if (AssetLoader::instance().takeBitmap(path, source)) {
+            if (source && (al_get_bitmap_flags(source) & ALLEGRO_MEMORY_BITMAP)) {
+                al_convert_bitmap(source); // Upload with the flags set above
+            }
+        }
+        else {
+            source = al_load_bitmap(path);
+        }
+        ownsSource = true;
+    }
+
+    if (!source || width <= 0 || height <= 0) {
+        al_restore_state(&state);
+        if (!source) {
+            std::cerr << "Failed to load sprite: " << path << "\n";
+            return fallback ? fallback(width, height) : nullptr;
+        }
+        return source;
+    }
+
+    int srcW = al_get_bitmap_width(source);
+    int srcH = al_get_bitmap_height(source);
+    float drawX = 0, drawY = 0, drawW = (float)width, drawH = (float)height;
+    if (mode == ScaleMode::Fit) {
+        float scale = std::min((float)width / srcW, (float)height / srcH);
+        drawW = srcW * scale;
+        drawH = srcH * scale;
+        drawX = (width - drawW) / 2;
+        drawY = (height - drawH) / 2;
+    }
+
+    // Bilinear filtering only looks at 2x2 texels, so big reductions are done
+    // in halving steps; a single pass would skip most source pixels and alias
+    al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+    while (srcW >= 2 * drawW && srcH >= 2 * drawH) {
+        ALLEGRO_BITMAP* half = al_create_bitmap(srcW / 2, srcH / 2);
+        if (!half) break;
+        al_set_target_bitmap(half);
+        al_draw_scaled_bitmap(source, 0, 0, srcW, srcH, 0, 0, srcW / 2, srcH / 2, 0);
+        if (ownsSource) al_destroy_bitmap(source);
+        source = half;
+        ownsSource = true;
+        srcW /= 2;
+        srcH /= 2;
+    }
+
+    al_set_new_bitmap_flags(plainFlags);
+    ALLEGRO_BITMAP* scaled = al_create_bitmap(width, height);
+    if (scaled) {
+        al_set_target_bitmap(scaled);
+        al_clear_to_color(al_map_rgba(0, 0, 0, 0)); // Transparent background
+        al_draw_scaled_bitmap(source, 0, 0, srcW, srcH, drawX, drawY, drawW, drawH, 0);
+    }
+    al_restore_state(&state);
+
+    if (ownsSource) al_destroy_bitmap(source);
+    return scaled;
+}
+
+bool SpriteCache::usePack(const char* path) {
+    if (!pack.open(path)) return false;
+    std::cout << "Sprite pack " << path << ": " << pack.getCount() << " sprites\n";
+    return true;
+}
+
+void SpriteCache::collectScaled(std::vector<std::pair<std::string, ALLEGRO_BITMAP*>>& sprites) const {
+    for (const auto& kv : entries) {
+        if (kv.second.bitmap && kv.second.refCount > 0 && kv.first.find('@') != std::string::npos) {
+            sprites.emplace_back(kv.first, kv.second.bitmap);
+        }
+    }
+}
+
+void SpriteCache::release(ALLEGRO_BITMAP* bitmap) {
+    if (!bitmap) return;
+    for (auto& kv : entries) {
+        if (kv.second.bitmap == bitmap) {
+            if (kv.second.refCount > 0) kv.second.refCount--;
+            return;
+        }
+    }
+}
+
+void SpriteCache::destroyEntry(Entry& entry) {
+    if (entry.bitmap) al_destroy_bitmap(entry.bitmap);
+    stats.residentBytes -= entry.bytes;
+    stats.residentCount--;
+    entry.bitmap = nullptr;
+    entry.bytes = 0;
+}
+
+void SpriteCache::trim() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.refCount == 0) {
+            destroyEntry(it->second);
+            it = entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void SpriteCache::clear() {
+    for (auto& kv : entries) {
+        destroyEntry(kv.second);
+    }
+    entries.clear();
+}
+
+void SpriteCache::printStats() const {
+    std::cout << "Sprite cache: " << stats.hits << " hits, " << stats.misses << " misses ("
+        << stats.packed << " from the pack), "
+        << stats.residentCount << " sprites / " << stats.residentBytes / 1024 << " KB resident\n";
+}
\ No newline at end of file
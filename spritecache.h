@@ -0,0 +1,82 @@
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+#include <allegro5/allegro.h>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "spritepack.h"
+
+// How a cached sprite is resized when a target size is requested
+enum class ScaleMode {
+    Stretch, // Fill the target size exactly
+    Fit      // Keep aspect ratio, centered on a transparent background
+};
+
+// Creates a placeholder bitmap when an asset fails to load. Receives the
+// requested size, which is 0x0 for native-size sprites.
+typedef ALLEGRO_BITMAP* (*SpriteFallback)(int width, int height);
+
+// Process-wide, reference-counted cache of decoded sprites keyed by asset path
+// (plus target size for scaled variants). Entries stay resident when their
+// reference count drops to zero so that respawning objects never hit the disk;
+// call trim() or clear() to actually free them.
+//
+// With a sprite pack open, scaled variants it holds are copied out of the
+// pack instead of being decoded and resampled.
+class SpriteCache {
+public:
+    struct Stats {
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+        unsigned long packed = 0; // Misses served from the sprite pack
+        size_t residentBytes = 0;
+        size_t residentCount = 0;
+    };
+
+    static SpriteCache& instance();
+
+    // Returns the sprite for path, loading it on first use. A width/height of 0
+    // returns the image at its native size. The returned bitmap is owned by the
+    // cache and must be handed back with release().
+    ALLEGRO_BITMAP* acquire(const char* path, int width = 0, int height = 0,
+        ScaleMode mode = ScaleMode::Stretch, SpriteFallback fallback = nullptr);
+    void release(ALLEGRO_BITMAP* bitmap);
+
+    // Serve scaled variants from the sprite pack at path from now on.
+    // Returns false (and keeps decoding) if it cannot be opened.
+    bool usePack(const char* path);
+    // Every scaled variant in use, keyed as a pack would store it
+    void collectScaled(std::vector<std::pair<std::string, ALLEGRO_BITMAP*>>& sprites) const;
+
+    void trim();  // Free entries nobody references anymore
+    void clear(); // Free everything (call before the display is destroyed)
+
+    const Stats& getStats() const { return stats; }
+    void printStats() const;
+
+private:
+    struct Entry {
+        ALLEGRO_BITMAP* bitmap = nullptr;
+        int refCount = 0;
+        size_t bytes = 0;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    SpritePack pack;
+    Stats stats;
+
+    SpriteCache() = default;
+    ~SpriteCache() = default;
+    SpriteCache(const SpriteCache&) = delete;
+    SpriteCache& operator=(const SpriteCache&) = delete;
+
+    static std::string makeKey(const char* path, int width, int height, ScaleMode mode);
+    static size_t bitmapBytes(ALLEGRO_BITMAP* bitmap);
+    ALLEGRO_BITMAP* load(const char* path, int width, int height, ScaleMode mode, SpriteFallback fallback);
+    void destroyEntry(Entry& entry);
+};
+
+#endif // SPRITECACHE_H
\ No newline at end of file
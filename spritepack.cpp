@@ -0,0 +1,219 @@
+#include "spritepack.h"
+#include "bytestream.h"
+#include <cstdio>
+#include <iostream>
+
+static const char MAGIC[4] = { 'T', 'R', 'S', 'P' };
+static const uint8_t VERSION = 2; // 2: source PNG stamps
+static const size_t DATA_ALIGNMENT = 16; // Each sprite's rows start on a 16-byte boundary
+
+// Layout: magic, version, sprite count, then one index record per sprite
+// (key length, key, width, height, pixel format, row pitch, data offset,
+// source PNG modification time and size), then the pixel rows of every
+// sprite, top to bottom
+
+// A real pixel layout, as opposed to the ANY_* requests; anything else read
+// from a file must not reach Allegro, which indexes its format table with it
+static bool isConcreteFormat(int32_t format) {
+    return format > ALLEGRO_PIXEL_FORMAT_ANY_32_WITH_ALPHA && format < ALLEGRO_NUM_PIXEL_FORMATS;
+}
+
+// Modification time and size of the PNG a sprite was scaled from (its key up
+// to the '@'), or -1 for both if there is no such file
+static void sourceStamp(const std::string& key, int64_t& time, int64_t& size) {
+    time = size = -1;
+    ALLEGRO_FS_ENTRY* file = al_create_fs_entry(key.substr(0, key.find('@')).c_str());
+    if (!file) return;
+    if (al_fs_entry_exists(file)) {
+        time = (int64_t)al_get_fs_entry_mtime(file);
+        size = (int64_t)al_get_fs_entry_size(file);
+    }
+    al_destroy_fs_entry(file);
+}
+
+bool SpritePack::open(const char* path) {
+    close();
+    if (!file.open(path)) return false;
+
+    const uint8_t* in = file.data();
+    const uint8_t* end = in + file.size();
+    uint8_t version = 0;
+    uint32_t count = 0;
+    if (file.size() < sizeof(MAGIC) || memcmp(in, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << "Not a sprite pack: " << path << "\n";
+        file.close();
+        return false;
+    }
+    in += sizeof(MAGIC);
+    if (!getValue(in, end, version) || version != VERSION || !getValue(in, end, count)) {
+        std::cerr << "Unsupported or damaged sprite pack header: " << path << "\n";
+        file.close();
+        return false;
+    }
+
+    uint32_t parsed = 0, stale = 0;
+    for (; parsed < count; parsed++) {
+        uint16_t keyLength = 0;
+        Entry entry;
+        if (!getValue(in, end, keyLength) || (size_t)(end - in) < keyLength) break;
+        std::string key((const char*)in, keyLength);
+        in += keyLength;
+        if (!getValue(in, end, entry.width) || !getValue(in, end, entry.height) ||
+            !getValue(in, end, entry.format) || !getValue(in, end, entry.pitch) ||
+            !getValue(in, end, entry.offset) || !getValue(in, end, entry.sourceTime) ||
+            !getValue(in, end, entry.sourceSize)) {
+            break;
+        }
+
+        if (!isConcreteFormat(entry.format)) break;
+        // Every row must lie inside the file
+        const int pixelSize = al_get_pixel_size(entry.format);
+        if (entry.width <= 0 || entry.height <= 0 || pixelSize <= 0 ||
+            entry.pitch < (uint32_t)entry.width * pixelSize || entry.offset > file.size() ||
+            (file.size() - entry.offset) / entry.pitch < (uint64_t)entry.height) {
+            break;
+        }
+
+        // A PNG that is gone leaves the packed copy as the only one
+        int64_t sourceTime, sourceSize;
+        sourceStamp(key, sourceTime, sourceSize);
+        if (sourceSize >= 0 && (sourceTime != entry.sourceTime || sourceSize != entry.sourceSize)) {
+            stale++;
+            continue;
+        }
+        index.emplace(key, entry);
+    }
+    if (parsed != count) {
+        std::cerr << "Damaged sprite pack index: " << path << "\n";
+        close();
+        return false;
+    }
+    if (stale > 0) {
+        std::cerr << "Sprite pack " << path << ": " << stale << " of " << count
+            << " sprites are older than their PNGs and are decoded instead; re-run the packer\n";
+    }
+    if (index.empty()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SpritePack::close() {
+    index.clear();
+    file.close();
+}
+
+ALLEGRO_BITMAP* SpritePack::create(const std::string& key) const {
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+    const Entry& entry = it->second;
+
+    ALLEGRO_BITMAP* bitmap = al_create_bitmap(entry.width, entry.height);
+    if (!bitmap) return nullptr;
+
+    // Locking in the stored format makes the copy a plain memcpy whenever it
+    // is the bitmap's own format; otherwise Allegro converts on unlock
+    ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(bitmap, entry.format, ALLEGRO_LOCK_WRITEONLY);
+    if (!region) {
+        al_destroy_bitmap(bitmap);
+        return nullptr;
+    }
+    const uint8_t* rows = file.data() + entry.offset;
+    const size_t rowBytes = (size_t)entry.width * al_get_pixel_size(entry.format);
+    for (int y = 0; y < entry.height; y++) {
+        memcpy((uint8_t*)region->data + (ptrdiff_t)y * region->pitch,
+            rows + (size_t)y * entry.pitch, rowBytes);
+    }
+    al_unlock_bitmap(bitmap);
+    return bitmap;
+}
+
+static size_t alignUp(size_t value) {
+    return (value + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+}
+
+bool SpritePack::write(const char* path,
+    const std::vector<std::pair<std::string, ALLEGRO_BITMAP*>>& sprites) {
+    // The index comes first, so its size fixes where the pixel data starts
+    size_t indexBytes = sizeof(MAGIC) + sizeof(VERSION) + sizeof(uint32_t);
+    for (const auto& sprite : sprites) {
+        indexBytes += sizeof(uint16_t) + sprite.first.size() + 4 * sizeof(int32_t) + sizeof(uint64_t) +
+            2 * sizeof(int64_t);
+    }
+
+    // Lock everything up front (read-only, in each bitmap's own format) to
+    // learn the formats and row sizes
+    std::vector<ALLEGRO_LOCKED_REGION*> regions;
+    std::vector<Entry> entries;
+    size_t offset = alignUp(indexBytes);
+    bool ok = true;
+    for (const auto& sprite : sprites) {
+        ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(sprite.second, ALLEGRO_PIXEL_FORMAT_ANY,
+            ALLEGRO_LOCK_READONLY);
+        if (!region || sprite.first.size() > UINT16_MAX) {
+            std::cerr << "Cannot pack sprite " << sprite.first << "\n";
+            if (region) al_unlock_bitmap(sprite.second);
+            ok = false;
+            break;
+        }
+        regions.push_back(region);
+
+        Entry entry;
+        entry.width = al_get_bitmap_width(sprite.second);
+        entry.height = al_get_bitmap_height(sprite.second);
+        entry.format = region->format;
+        entry.pitch = (uint32_t)entry.width * region->pixel_size;
+        entry.offset = offset;
+        sourceStamp(sprite.first, entry.sourceTime, entry.sourceSize);
+        entries.push_back(entry);
+        offset = alignUp(offset + (size_t)entry.pitch * entry.height);
+    }
+
+    FILE* out = ok ? fopen(path, "wb") : nullptr;
+    if (ok && !out) {
+        std::cerr << "Failed to create sprite pack: " << path << "\n";
+        ok = false;
+    }
+    if (ok) {
+        std::vector<uint8_t> header(indexBytes);
+        uint8_t* at = header.data();
+        memcpy(at, MAGIC, sizeof(MAGIC));
+        at += sizeof(MAGIC);
+        at = putValue(at, VERSION);
+        at = putValue(at, (uint32_t)sprites.size());
+        for (size_t i = 0; i < sprites.size(); i++) {
+            const std::string& key = sprites[i].first;
+            at = putValue(at, (uint16_t)key.size());
+            memcpy(at, key.data(), key.size());
+            at += key.size();
+            at = putValue(at, entries[i].width);
+            at = putValue(at, entries[i].height);
+            at = putValue(at, entries[i].format);
+            at = putValue(at, entries[i].pitch);
+            at = putValue(at, entries[i].offset);
+            at = putValue(at, entries[i].sourceTime);
+            at = putValue(at, entries[i].sourceSize);
+        }
+        ok = fwrite(header.data(), 1, header.size(), out) == header.size();
+
+        static const uint8_t padding[DATA_ALIGNMENT] = {};
+        size_t written = header.size();
+        for (size_t i = 0; ok && i < sprites.size(); i++) {
+            const Entry& entry = entries[i];
+            ok = fwrite(padding, 1, entry.offset - written, out) == entry.offset - written;
+            for (int y = 0; ok && y < entry.height; y++) {
+                const uint8_t* row = (const uint8_t*)regions[i]->data + (ptrdiff_t)y * regions[i]->pitch;
+                ok = fwrite(row, 1, entry.pitch, out) == entry.pitch;
+            }
+            written = entry.offset + (size_t)entry.pitch * entry.height;
+        }
+        if (fclose(out) != 0) ok = false;
+        if (!ok) std::cerr << "Failed to write sprite pack: " << path << "\n";
+    }
+
+    for (size_t i = 0; i < regions.size(); i++) {
+        al_unlock_bitmap(sprites[i].second);
+    }
+    return ok;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef SPRITEPACK_H
+#define SPRITEPACK_H
+
+#include <allegro5/allegro.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "mappedfile.h"
+
+// A file of sprites baked offline (tools/packer.cpp) at their final
+// on-screen size, as raw rows of pixels in the format the packer was told
+// the display uses. The game memory-maps it and copies each sprite straight
+// from the mapping into a new bitmap: no PNG decoding and no resampling.
+// Sprites are looked up by SpriteCache key (path plus size). Each one also
+// records the size and modification time of its source PNG; open() skips
+// sprites whose PNG has changed since, so they are decoded afresh until the
+// pack is rebuilt.
+class SpritePack {
+public:
+    SpritePack() = default;
+
+    // Maps the pack and reads its index. False if it is damaged or holds no
+    // sprite that is still up to date.
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return !index.empty(); }
+    size_t getCount() const { return index.size(); }
+
+    // A new bitmap (made with the current new-bitmap flags) holding the
+    // packed sprite for key, or null if the pack does not have it
+    ALLEGRO_BITMAP* create(const std::string& key) const;
+
+    // Writes every bitmap, under its key, to a new pack at path. Each one is
+    // stored in its own pixel format.
+    static bool write(const char* path,
+        const std::vector<std::pair<std::string, ALLEGRO_BITMAP*>>& sprites);
+
+private:
+    struct Entry {
+        int32_t width, height;
+        int32_t format;  // ALLEGRO_PIXEL_FORMAT of the stored rows
+        uint32_t pitch;  // Bytes per stored row
+        uint64_t offset; // Of the first row, from the start of the file
+        int64_t sourceTime, sourceSize; // Of the source PNG when packed; -1 if it was missing
+    };
+
+    MappedFile file;
+    std::unordered_map<std::string, Entry> index;
+
+    SpritePack(const SpritePack&) = delete;
+    SpritePack& operator=(const SpritePack&) = delete;
+};
+
+#endif // SPRITEPACK_H
\ No newline at end of file
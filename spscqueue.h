@@ -0,0 +1,46 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single-producer/single-consumer FIFO of at most CAPACITY values
+// in a fixed ring. push() and pop() never allocate or wait; a push into a
+// full queue fails instead, so a stalled consumer can never hold up the
+// producer. CAPACITY must be a power of two.
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+public:
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer side. Returns false (and drops value) if the queue is full.
+    bool push(const T& value) {
+        size_t at = tail.load(std::memory_order_relaxed);
+        if (at - head.load(std::memory_order_acquire) == CAPACITY) return false;
+        slots[at & (CAPACITY - 1)] = value;
+        tail.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool pop(T& value) {
+        size_t at = head.load(std::memory_order_relaxed);
+        if (at == tail.load(std::memory_order_acquire)) return false;
+        value = slots[at & (CAPACITY - 1)];
+        head.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T slots[CAPACITY];
+    // Free-running counts; only their difference wraps into the ring
+    std::atomic<size_t> head; // Next to pop, written by the consumer
+    std::atomic<size_t> tail; // Next to push, written by the producer
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+};
+
+#endif // SPSCQUEUE_H
\ No newline at end of file
@@ -0,0 +1,271 @@
+// Simulation microbenchmarks: times the hot Highway paths with car pools from
+// the shipped 12 up to 100k and compares them with a committed baseline.
+// Needs no Allegro. Pools above the shipped one run rows packed closely
+// enough (HighwayConfig::rowSpacing) to keep about nine in ten of their cars
+// on the road, so they measure dense traffic, not parked entries.
+//
+// Build from the repository root:
+//   g++ -O2 -std=c++14 -DNDEBUG -DTRACK_ALLOCATIONS tools/bench.cpp highway.cpp traffic.cpp
+//       levels.cpp coin.cpp environment.cpp collision.cpp broadphase.cpp alloccounter.cpp -o bench
+//
+// Usage:
+//   ./bench                                         print the results
+//   ./bench --baseline tools/bench_baseline.txt     also fail (exit 1) if any scenario
+//           [--threshold 25]                        is more than 25% slower
+//   ./bench --write-baseline tools/bench_baseline.txt
+//
+// Every scenario must also stay allocation-free; any allocation fails the run.
+#include "../alloccounter.h"
+#include "../constants.h"
+#include "../environment.h"
+#include "../highway.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const int ENTITY_COUNTS[] = { 12, 50, 500, 5000, 50000, 100000 };
+static const double ENTITY_OPS_PER_RUN = 2e6; // Work per measured run, in entity updates
+static const int RUNS = 5;                     // Best of this many runs is reported
+static const uint64_t SEED = 42;
+static const long EPISODE_TICKS = 400;         // Update runs restart from a fresh road this often
+
+struct Result {
+    std::string scenario;
+    int entities;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+// One benchmarked operation on a live highway. Returns the nanoseconds spent
+// in the measured part for ops operations.
+typedef double (*ScenarioFn)(Highway& highway, Player& player, long ops);
+
+struct Scenario {
+    const char* name;
+    ScenarioFn run;
+    long minOps; // Operations per run never drop below this, whatever the entity count
+};
+
+static double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void sweepPlayer(Player& player, long tick) {
+    // Same lane sweep as the headless runner
+    player.velocityX = ((tick / 120) % 2 == 0) ? 5.0f : -5.0f;
+    player.update();
+}
+
+// Highway::update: scrolling, parking cars and coins that leave the screen and
+// laying new pattern rows. Traffic keeps speeding up, so without game overs the cost would keep
+// drifting; runs are split into episodes that start from an untimed reset.
+static double benchUpdate(Highway& highway, Player&, long ops) {
+    double ns = 0;
+    for (long done = 0; done < ops;) {
+        highway.reset(SEED);
+        Clock::time_point start = Clock::now();
+        for (long tick = 0; tick < EPISODE_TICKS && done < ops; tick++, done++) {
+            highway.update();
+        }
+        ns += elapsedNs(start);
+    }
+    return ns;
+}
+
+// Highway::checkCollisions: broadphase query plus batch narrowphase
+static double benchCollide(Highway& highway, Player& player, long ops) {
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < ops; i++) {
+        sweepPlayer(player, i);
+        highway.checkCollisions();
+    }
+    return elapsedNs(start);
+}
+
+// Highway::increaseLevel: swaps the world speed scale, so it should cost the
+// same at every density. Called directly, so it runs past the last level
+// (which keeps the last table entry); an untimed reset every 64 level-ups
+// keeps the level number small.
+static double benchLevelUp(Highway& highway, Player&, long ops) {
+    double ns = 0;
+    for (long done = 0; done < ops;) {
+        highway.reset(SEED);
+        Clock::time_point start = Clock::now();
+        for (int level = 0; level < 64 && done < ops; level++, done++) {
+            highway.increaseLevel();
+        }
+        ns += elapsedNs(start);
+    }
+    return ns;
+}
+
+// Highway::reset: parks every obstacle and coin and lays the first screen of rows
+static double benchSpawn(Highway& highway, Player&, long ops) {
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < ops; i++) {
+        highway.reset(SEED + i);
+    }
+    return elapsedNs(start);
+}
+
+// Highway::saveSnapshot + restoreSnapshot: one rewind step or lookahead clone
+static double benchSnapshot(Highway& highway, Player&, long ops) {
+    static std::vector<uint8_t> buffer;
+    buffer.resize(highway.getSnapshotCapacity()); // Untimed; reused across runs
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < ops; i++) {
+        size_t size = highway.saveSnapshot(buffer.data());
+        highway.restoreSnapshot(buffer.data(), size);
+    }
+    return elapsedNs(start);
+}
+
+static Result measure(const Scenario& scenario, int entities) {
+    HighwayConfig config;
+    if (entities > config.obstacleCount) {
+        // About one and a half cars per row, so this many rows on the road
+        // fill the pool
+        config.rowSpacing = (float)(SCREEN_HEIGHT + Obstacle::HEIGHT) * 3 / (2 * entities);
+    }
+    config.obstacleCount = entities;
+    config.coinCount = entities * 2 / 3; // Keep the shipped 12:8 ratio
+
+    Player player(SCREEN_WIDTH / 2 - 50, SCREEN_HEIGHT - 130, SCREEN_HEIGHT);
+    Highway highway(player, SEED, config);
+
+    long ops = std::max(scenario.minOps, (long)(ENTITY_OPS_PER_RUN / entities));
+    scenario.run(highway, player, ops); // Warm-up
+
+    Result result = { scenario.name, entities, 1e300, 0 };
+    for (int run = 0; run < RUNS; run++) {
+        unsigned long long allocations = allocation_count();
+        double ns = scenario.run(highway, player, ops);
+        allocations = allocation_count() - allocations;
+
+        result.nsPerOp = std::min(result.nsPerOp, ns / ops);
+        result.allocsPerOp = std::max(result.allocsPerOp, (double)allocations / ops);
+    }
+    return result;
+}
+
+static std::string key(const std::string& scenario, int entities) {
+    return scenario + " " + std::to_string(entities);
+}
+
+static bool loadBaseline(const char* path, std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open baseline: " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string scenario;
+        int entities;
+        double ns;
+        if (fields >> scenario >> entities >> ns) {
+            baseline[key(scenario, entities)] = ns;
+        }
+    }
+    return true;
+}
+
+static bool writeBaseline(const char* path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write baseline: " << path << "\n";
+        return false;
+    }
+    out << "# Highway microbenchmark baseline, written by tools/bench.cpp --write-baseline\n";
+    out << "# scenario entities ns_per_op\n";
+    for (const Result& r : results) {
+        out << r.scenario << " " << r.entities << " " << r.nsPerOp << "\n";
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* baselinePath = nullptr;
+    const char* writePath = nullptr;
+    double threshold = 25.0; // Allowed slowdown in percent
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) {
+            writePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        }
+        else {
+            std::cerr << "Unknown argument: " << argv[i] << "\n";
+            return 2;
+        }
+    }
+
+    unsigned long long before = allocation_count();
+    ::operator delete(::operator new(1)); // Not elidable, unlike a new-expression
+    if (allocation_count() == before) {
+        std::cerr << "Note: allocation counting is off, build with -DTRACK_ALLOCATIONS\n";
+    }
+
+    std::map<std::string, double> baseline;
+    if (baselinePath && !loadBaseline(baselinePath, baseline)) {
+        return 2;
+    }
+
+    const Scenario scenarios[] = {
+        { "update", benchUpdate, EPISODE_TICKS },
+        { "collide", benchCollide, 1000 },
+        { "levelup", benchLevelUp, 64 },
+        { "spawn", benchSpawn, 10 },
+        { "snapshot", benchSnapshot, 1000 },
+    };
+
+    std::vector<Result> results;
+    bool failed = false;
+    printf("%-8s %9s %14s %12s %12s\n", "scenario", "entities", "ns/op", "allocs/op", "vs baseline");
+    for (const Scenario& scenario : scenarios) {
+        for (int entities : ENTITY_COUNTS) {
+            Result r = measure(scenario, entities);
+            results.push_back(r);
+
+            char delta[32] = "-";
+            auto base = baseline.find(key(r.scenario, r.entities));
+            if (base != baseline.end()) {
+                double percent = (r.nsPerOp / base->second - 1) * 100;
+                snprintf(delta, sizeof(delta), "%+.1f%%%s", percent, percent > threshold ? " FAIL" : "");
+                if (percent > threshold) failed = true;
+            }
+            if (r.allocsPerOp > 0) failed = true;
+
+            printf("%-8s %9d %14.1f %12.3f %12s\n", r.scenario.c_str(), r.entities,
+                r.nsPerOp, r.allocsPerOp, delta);
+            fflush(stdout);
+        }
+    }
+
+    if (writePath && !writeBaseline(writePath, results)) {
+        return 2;
+    }
+    if (failed) {
+        std::cerr << "Benchmark regression: a scenario exceeded the " << threshold
+            << "% threshold or allocated\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
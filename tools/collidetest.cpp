@@ -0,0 +1,174 @@
+// Collision kernel test: checks the hit mask of collideBatch bit for bit
+// against the scalar Obstacle::checkCollision and Coin::checkCollision on
+// random layouts, including boxes that touch the player box exactly or miss
+// it by one float step. Needs no Allegro.
+//
+// collideBatch picks its SIMD path when it is compiled, so build the test
+// once per path from the repository root:
+//   g++ -O2 -std=c++14 -mavx tools/collidetest.cpp highway.cpp traffic.cpp levels.cpp
+//       coin.cpp environment.cpp collision.cpp broadphase.cpp alloccounter.cpp -o collidetest_avx
+//   (no -mavx)            SSE, the x86-64 default             -o collidetest_sse
+//   -DCOLLISION_NO_SIMD   scalar                              -o collidetest_scalar
+//
+// Usage:
+//   ./collidetest [--trials 20000] [--seed 1]
+//
+// Exits with 1 on the first mismatch, after printing it.
+#include "../coin.h"
+#include "../collision.h"
+#include "../environment.h"
+#include "../highway.h"
+#include "../rng.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(COLLISION_NO_SIMD)
+static const char* const KERNEL = "scalar";
+#elif defined(__AVX__)
+static const char* const KERNEL = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+static const char* const KERNEL = "SSE";
+#else
+static const char* const KERNEL = "scalar";
+#endif
+
+static const size_t MAX_COUNT = 100;  // Covers every SIMD width plus a remainder
+static const uint32_t SENTINEL = 0xA5A5A5A5u;
+
+struct Totals {
+    unsigned long long entities = 0;
+    unsigned long long hits = 0;
+    unsigned long long edges = 0; // Entities placed on or one step off an edge
+};
+
+// Uniform float in [low, high), whole numbers only when integral is set (the
+// game's lanes and speeds keep most coordinates whole, which makes exact
+// touching common)
+static float randomIn(Rng& rng, float low, float high, bool integral) {
+    float value = low + (high - low) * (rng.next() >> 8) * (1.0f / (1 << 24));
+    return integral ? std::floor(value) : value;
+}
+
+// One float step towards -inf, none, or towards +inf
+static float nudge(Rng& rng, float value) {
+    switch (rng.nextInt(3)) {
+    case 0: return std::nextafter(value, -INFINITY);
+    case 1: return value;
+    default: return std::nextafter(value, INFINITY);
+    }
+}
+
+// A position whose padded box is near box; about half of them sit exactly on
+// (or one float step off) one or two of its edges
+static void placeEntity(Rng& rng, const EntityShape& shape, const CollisionBox& box,
+    bool integral, float& x, float& y, Totals& totals) {
+    x = randomIn(rng, box.left - shape.offsetX - shape.width - 8, box.right - shape.offsetX + 8, integral);
+    y = randomIn(rng, box.top - shape.offsetY - shape.height - 8, box.bottom - shape.offsetY + 8, integral);
+
+    int edges = rng.nextInt(4); // 0 or 1: free, 2: one edge, 3: a corner
+    if (edges < 2) return;
+    totals.edges++;
+    bool onX = edges == 3 || rng.nextInt(2) == 0;
+    bool onY = edges == 3 || !onX;
+    if (onX) {
+        // Entity left on the box's right edge, or entity right on its left edge
+        x = rng.nextInt(2) ? box.right - shape.offsetX : box.left - shape.offsetX - shape.width;
+        x = nudge(rng, x);
+    }
+    if (onY) {
+        y = rng.nextInt(2) ? box.bottom - shape.offsetY : box.top - shape.offsetY - shape.height;
+        y = nudge(rng, y);
+    }
+}
+
+// Fills count entities, runs collideBatch on them starting at a random
+// (possibly unaligned) offset and compares every bit, the hit count and the
+// untouched word after the mask with the scalar test
+static bool checkLayout(Rng& rng, const char* name, const EntityShape& shape,
+    bool (*scalar)(float, float, const Player&), const Player& player, size_t count,
+    bool integral, std::vector<float>& xs, std::vector<float>& ys,
+    std::vector<uint32_t>& mask, Totals& totals) {
+    const CollisionBox box = playerCollisionBox(player);
+    const size_t offset = rng.nextInt(8);
+    for (size_t i = 0; i < count; i++) {
+        placeEntity(rng, shape, box, integral, xs[offset + i], ys[offset + i], totals);
+    }
+
+    const size_t words = hitMaskWords(count);
+    std::fill(mask.begin(), mask.end(), SENTINEL);
+    size_t hits = collideBatch(xs.data() + offset, ys.data() + offset, count, shape, box, mask.data());
+
+    size_t expected = 0;
+    for (size_t i = 0; i < words * 32; i++) {
+        bool want = i < count && scalar(xs[offset + i], ys[offset + i], player);
+        bool got = ((mask[i / 32] >> (i % 32)) & 1u) != 0;
+        if (want) expected++;
+        if (want != got) {
+            printf("MISMATCH %s entity %zu of %zu: batch %d, scalar %d\n", name, i, count, got, want);
+            if (i < count) {
+                printf("  entity x %.9g y %.9g, player box %.9g %.9g %.9g %.9g\n",
+                    xs[offset + i], ys[offset + i], box.left, box.top, box.right, box.bottom);
+            }
+            return false;
+        }
+    }
+    if (hits != expected || mask[words] != SENTINEL) {
+        printf("MISMATCH %s with %zu entities: returned %zu hits for %zu, word after mask %s\n",
+            name, count, hits, expected, mask[words] == SENTINEL ? "intact" : "overwritten");
+        return false;
+    }
+    totals.entities += count;
+    totals.hits += hits;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    long trials = 20000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+            trials = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            std::cerr << "Unknown argument: " << argv[i] << "\n";
+            return 2;
+        }
+    }
+
+    Rng rng(seed);
+    std::vector<float> xs(MAX_COUNT + 8), ys(MAX_COUNT + 8);
+    std::vector<uint32_t> mask(hitMaskWords(MAX_COUNT) + 1);
+    Totals totals;
+    Player player(0, 0, SCREEN_HEIGHT);
+
+    for (long trial = 0; trial < trials; trial++) {
+        // Half the layouts use whole-pixel coordinates, half fractional ones
+        bool integral = (trial & 1) == 0;
+        player.x = randomIn(rng, -50, SCREEN_WIDTH, integral);
+        player.y = randomIn(rng, -50, SCREEN_HEIGHT, integral);
+        player.frameWidth = 2 * (int)Player::collisionOffsetX + 1 + rng.nextInt(100);
+        player.frameHeight = 2 * (int)Player::collisionOffsetY + 1 + rng.nextInt(100);
+        size_t count = rng.nextInt((int)MAX_COUNT + 1);
+
+        if (!checkLayout(rng, "car", Obstacle::getCollisionShape(), Obstacle::checkCollision,
+                player, count, integral, xs, ys, mask, totals) ||
+            !checkLayout(rng, "coin", Coin::getCollisionShape(), Coin::checkCollision,
+                player, count, integral, xs, ys, mask, totals)) {
+            printf("%s kernel FAILED at trial %ld (seed %llu)\n", KERNEL, trial,
+                (unsigned long long)seed);
+            return 1;
+        }
+    }
+
+    printf("%s kernel: %ld layouts, %llu entities (%llu on or next to an edge), %llu hits, all match\n",
+        KERNEL, trials * 2, totals.entities, totals.edges, totals.hits);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+// Sprite packer: bakes every sprite the game draws, already scaled to its
+// on-screen size, into one pack file that the game memory-maps at startup
+// (assets/sprites.pack) instead of decoding and resampling the PNGs. Needs
+// Allegro but no display.
+//
+// Build from the repository root:
+//   g++ -O2 -std=c++14 -pthread tools/packer.cpp renderer.cpp bike.cpp spriteatlas.cpp
+//       spritecache.cpp spritepack.cpp mappedfile.cpp assetloader.cpp
+//       -lallegro -lallegro_image -lallegro_primitives -o packer
+//
+// Usage (run where assets/ is, and again whenever a sprite PNG changes):
+//   ./packer [--out assets/sprites.pack] [--size 800x600]... [--format argb|abgr]
+//
+// Sprites are baked for each --size window size (the starting window size if
+// none is given); the game decodes the PNGs for any other size as before.
+// --format is the display's pixel format: argb for Direct3D (the Windows
+// default), abgr for OpenGL. A mismatch still works, but each sprite is then
+// converted while it is uploaded.
+#include "../bike.h"
+#include "../constants.h"
+#include "../renderer.h"
+#include "../spritecache.h"
+#include "../spritepack.h"
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_image.h>
+#include <allegro5/allegro_primitives.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+struct WindowSize {
+    int width, height;
+};
+
+int main(int argc, char** argv) {
+    const char* outPath = "assets/sprites.pack";
+    std::vector<WindowSize> sizes;
+    int format = ALLEGRO_PIXEL_FORMAT_ARGB_8888;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            WindowSize size;
+            if (sscanf(argv[++i], "%dx%d", &size.width, &size.height) != 2 ||
+                size.width <= 0 || size.height <= 0) {
+                std::cerr << "Bad --size " << argv[i] << ", expected WIDTHxHEIGHT\n";
+                return 1;
+            }
+            sizes.push_back(size);
+        }
+        else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "argb") == 0) format = ALLEGRO_PIXEL_FORMAT_ARGB_8888;
+            else if (strcmp(name, "abgr") == 0) format = ALLEGRO_PIXEL_FORMAT_ABGR_8888;
+            else {
+                std::cerr << "Unknown --format " << name << ", expected argb or abgr\n";
+                return 1;
+            }
+        }
+        else {
+            std::cerr << "Unknown argument: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes.push_back({ SCREEN_WIDTH, SCREEN_HEIGHT });
+    }
+
+    if (!al_init() || !al_init_image_addon() || !al_init_primitives_addon()) {
+        std::cerr << "Failed to initialize Allegro!\n";
+        return 1;
+    }
+    // Without a display every bitmap is a memory bitmap; the packed pixels
+    // are whatever the game's own resampling produces for the same request
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+    al_set_new_bitmap_format(format);
+
+    // The renderer requests exactly the sprites the game will, so the pack
+    // holds them under the keys the game looks up. Each size is copied out
+    // before the next resize trims it from the cache.
+    std::map<std::string, ALLEGRO_BITMAP*> baked;
+    {
+        Bike bike;
+        Renderer renderer(bike);
+        for (const WindowSize& size : sizes) {
+            renderer.resize(size.width, size.height);
+            std::vector<std::pair<std::string, ALLEGRO_BITMAP*>> sprites;
+            SpriteCache::instance().collectScaled(sprites);
+            for (const auto& sprite : sprites) {
+                if (!baked.count(sprite.first)) {
+                    baked[sprite.first] = al_clone_bitmap(sprite.second);
+                }
+            }
+        }
+    }
+    SpriteCache::instance().clear();
+
+    std::vector<std::pair<std::string, ALLEGRO_BITMAP*>> sprites(baked.begin(), baked.end());
+    size_t bytes = 0;
+    for (const auto& sprite : sprites) {
+        std::cout << "  " << sprite.first << "\n";
+        bytes += (size_t)al_get_bitmap_width(sprite.second) * al_get_bitmap_height(sprite.second) * 4;
+    }
+    bool ok = SpritePack::write(outPath, sprites);
+    if (ok) {
+        std::cout << "Packed " << sprites.size() << " sprites (" << bytes / 1024 << " KB) into "
+            << outPath << "\n";
+    }
+
+    for (const auto& sprite : sprites) {
+        al_destroy_bitmap(sprite.second);
+    }
+    return ok ? 0 : 1;
+}
\ No newline at end of file
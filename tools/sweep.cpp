@@ -0,0 +1,232 @@
+// Balancing sweep: plays many automated episodes for every combination of a
+// parameter grid, spread over all cores, and writes aggregated statistics.
+// Needs no Allegro.
+//
+// Build from the repository root:
+//   g++ -O2 -std=c++14 -DNDEBUG -pthread tools/sweep.cpp batchenv.cpp highway.cpp traffic.cpp
+//       levels.cpp coin.cpp environment.cpp collision.cpp broadphase.cpp alloccounter.cpp -o sweep
+//
+// Usage:
+//   ./sweep tools/sweep_grid.txt [--out results.csv] [--episodes 10000]
+//           [--envs 1024] [--threads 0] [--max-ticks 20000] [--seed 1]
+//
+// The grid file has one "name = value, value, ..." line per parameter (see
+// tools/sweep_grid.txt); parameters that are left out keep the shipped value.
+#include "../batchenv.h"
+#include "../constants.h"
+#include "../highway.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// A parameter the grid can vary and how to apply one of its values
+struct Parameter {
+    const char* name;
+    void (*apply)(HighwayConfig& config, double value);
+};
+
+static const Parameter PARAMETERS[] = {
+    { "coinsForLevelUp", [](HighwayConfig& c, double v) { c.coinsForLevelUp = (int)v; } },
+    { "levelSpeedMultiplier", [](HighwayConfig& c, double v) { c.levelSpeedMultiplier = (float)v; } },
+    { "rowSpacing", [](HighwayConfig& c, double v) { c.rowSpacing = (float)v; } },
+    { "obstacleCount", [](HighwayConfig& c, double v) { c.obstacleCount = (int)v; } },
+    { "coinCount", [](HighwayConfig& c, double v) { c.coinCount = (int)v; } },
+};
+static const int PARAMETER_COUNT = sizeof(PARAMETERS) / sizeof(PARAMETERS[0]);
+
+struct GridAxis {
+    const Parameter* parameter;
+    std::vector<double> values;
+};
+
+static std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+static bool loadGrid(const char* path, std::vector<GridAxis>& grid) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open grid: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        size_t equals = line.find('=');
+        std::string name = trim(line.substr(0, equals));
+        const Parameter* parameter = nullptr;
+        for (const Parameter& p : PARAMETERS) {
+            if (name == p.name) parameter = &p;
+        }
+        if (equals == std::string::npos || !parameter) {
+            std::cerr << path << ":" << lineNumber << ": unknown parameter '" << name << "'\n";
+            return false;
+        }
+
+        GridAxis axis;
+        axis.parameter = parameter;
+        std::stringstream values(line.substr(equals + 1));
+        std::string value;
+        while (std::getline(values, value, ',')) {
+            axis.values.push_back(atof(trim(value).c_str()));
+        }
+        if (axis.values.empty()) {
+            std::cerr << path << ":" << lineNumber << ": no values for '" << name << "'\n";
+            return false;
+        }
+        grid.push_back(axis);
+    }
+    return true;
+}
+
+// Reference bot. Cars drive down the middle of their lanes, so the bike is
+// safe on a lane boundary; it waits there and only dips into a neighbouring
+// lane for a coin when the nearest car in that lane is well behind the coin.
+static int coinBot(const Observation& observation) {
+    const float bikeWidth = 100;   // Player's default frame width
+    const float carMargin = 400;   // Clear road needed beyond a coin to go for it
+
+    // Closest lane boundary: the right edge of lane 0, 1 or 2
+    int home = 0;
+    float target = 0;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        float spot = LANE_POSITIONS[lane] + LANE_WIDTH - bikeWidth / 2;
+        if (lane == 0 || std::fabs(spot - observation.playerX) < std::fabs(target - observation.playerX)) {
+            home = lane;
+            target = spot;
+        }
+    }
+
+    // The lanes on either side of that boundary
+    float bestCoin = SCREEN_HEIGHT;
+    for (int lane = home; lane <= home + 1 && lane < LANE_COUNT; lane++) {
+        float coin = observation.coinGap[lane];
+        if (coin < bestCoin && observation.obstacleGap[lane] > coin + carMargin) {
+            bestCoin = coin;
+            target = LANE_POSITIONS[lane] + (LANE_WIDTH - bikeWidth) / 2;
+        }
+    }
+
+    float offset = target - observation.playerX;
+    if (std::fabs(offset) < 5) return HighwayEnv::STAY;
+    return offset > 0 ? HighwayEnv::RIGHT : HighwayEnv::LEFT;
+}
+
+int main(int argc, char** argv) {
+    const char* gridPath = nullptr;
+    const char* outPath = nullptr;
+    BatchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--episodes") == 0 && i + 1 < argc) {
+            options.episodes = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--envs") == 0 && i + 1 < argc) {
+            options.envs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            options.maxTicks = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!gridPath && argv[i][0] != '-') {
+            gridPath = argv[i];
+        }
+        else {
+            std::cerr << "Unknown argument: " << argv[i] << "\n";
+            return 2;
+        }
+    }
+    if (!gridPath) {
+        std::cerr << "Usage: sweep GRID_FILE [--out FILE] [--episodes N] [--envs N] [--threads N]"
+            " [--max-ticks N] [--seed N]\n";
+        return 2;
+    }
+
+    std::vector<GridAxis> grid;
+    if (!loadGrid(gridPath, grid)) {
+        return 2;
+    }
+
+    std::ofstream out;
+    if (outPath) {
+        out.open(outPath);
+        if (!out) {
+            std::cerr << "Failed to open output: " << outPath << "\n";
+            return 2;
+        }
+        for (const GridAxis& axis : grid) {
+            out << axis.parameter->name << ",";
+        }
+        out << "episodes,truncated,mean_score,min_score,max_score,mean_ticks,mean_level,"
+            "mean_coins,max_level_rate\n";
+    }
+
+    // Walk the cartesian product like an odometer, last axis fastest
+    std::vector<size_t> position(grid.size(), 0);
+    unsigned long long totalTicks = 0;
+    double totalSeconds = 0;
+    for (bool more = true; more;) {
+        HighwayConfig config;
+        for (size_t a = 0; a < grid.size(); a++) {
+            grid[a].parameter->apply(config, grid[a].values[position[a]]);
+            printf("%s=%g ", grid[a].parameter->name, grid[a].values[position[a]]);
+        }
+
+        BatchStats stats = run_batch(config, options, coinBot);
+        double n = stats.episodes > 0 ? (double)stats.episodes : 1.0;
+        printf("-> %llu episodes, mean score %.1f, mean ticks %.0f, max level %.1f%% (%.3g ticks/s)\n",
+            stats.episodes, stats.totalScore / n, stats.ticks / n, 100.0 * stats.reachedMaxLevel / n,
+            stats.seconds > 0 ? stats.ticks / stats.seconds : 0.0);
+        fflush(stdout);
+        totalTicks += stats.ticks;
+        totalSeconds += stats.seconds;
+
+        if (out) {
+            for (size_t a = 0; a < grid.size(); a++) {
+                out << grid[a].values[position[a]] << ",";
+            }
+            out << stats.episodes << "," << stats.truncated << "," << stats.totalScore / n << ","
+                << stats.minScore << "," << stats.maxScore << "," << stats.ticks / n << ","
+                << stats.totalLevel / n << "," << stats.totalCoins / n << ","
+                << stats.reachedMaxLevel / n << "\n";
+        }
+
+        more = false;
+        for (size_t a = grid.size(); a-- > 0;) {
+            if (++position[a] < grid[a].values.size()) {
+                more = true;
+                break;
+            }
+            position[a] = 0;
+        }
+    }
+
+    printf("Total: %llu ticks in %.2f s (%.3g ticks/s)\n", totalTicks, totalSeconds,
+        totalSeconds > 0 ? totalTicks / totalSeconds : 0.0);
+    if (outPath) {
+        std::cout << "Results written to " << outPath << "\n";
+    }
+    return 0;
+}
\ No newline at end of file
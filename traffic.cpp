@@ -0,0 +1,147 @@
+#include "traffic.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+// Patterns per tier, sparse to dense. Lane bits: 1 left, 2 middle, 4 right.
+static constexpr TrafficPattern PATTERNS[] = {
+    // Tier 0: single cars
+    { 2, { { 1, 2 }, { 4, -1 } } },
+    { 3, { { 2, 0 }, { 2, -1 }, { 2, 2 } } },
+    { 3, { { 1, -1 }, { 1, 1 }, { 1, -1 } } },
+    { 1, { { 4, 1 } } },
+    { 2, { { 1, 1 }, { 2, -1 } } },
+
+    // Tier 1: pairs that leave a gap to aim for
+    { 2, { { 3, 2 }, { 1, -1 } } },
+    { 3, { { 5, 1 }, { 4, -1 }, { 5, -1 } } },
+    { 3, { { 6, 0 }, { 4, 1 }, { 6, -1 } } },
+    { 3, { { 1, 2 }, { 2, -1 }, { 1, 2 } } },
+    { 2, { { 2, 0 }, { 3, 2 } } },
+
+    // Tier 2: long runs of pairs
+    { 3, { { 3, 2 }, { 1, 2 }, { 3, -1 } } },
+    { 3, { { 5, 1 }, { 5, -1 }, { 1, 1 } } },
+    { 4, { { 6, 0 }, { 6, 0 }, { 4, -1 }, { 6, -1 } } },
+    { 3, { { 3, -1 }, { 2, 0 }, { 3, 2 } } },
+    { 3, { { 5, -1 }, { 1, 1 }, { 5, 1 } } },
+};
+
+struct PatternRange {
+    int first;
+    int count;
+};
+
+static constexpr PatternRange TIER_PATTERNS[TrafficGenerator::TIERS] = {
+    { 0, 5 },
+    { 5, 5 },
+    { 10, 5 },
+};
+
+static constexpr int PATTERN_COUNT = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+static constexpr int ALL_LANES = (1 << LANE_COUNT) - 1;
+
+// Offline checks: every pattern has a lane that is free in all its rows,
+// and coins only go into free lanes
+static constexpr bool isFair(const TrafficPattern& pattern) {
+    if (pattern.rowCount < 1 || pattern.rowCount > TrafficPattern::MAX_ROWS) return false;
+    int freeLanes = ALL_LANES;
+    for (int r = 0; r < pattern.rowCount; r++) {
+        const PatternRow& row = pattern.rows[r];
+        if (row.cars & ~ALL_LANES) return false;
+        if (row.coinLane >= LANE_COUNT || (row.coinLane >= 0 && (row.cars >> row.coinLane) & 1)) {
+            return false;
+        }
+        freeLanes &= ~row.cars;
+    }
+    return freeLanes != 0;
+}
+
+static constexpr bool allFair() {
+    for (int i = 0; i < PATTERN_COUNT; i++) {
+        if (!isFair(PATTERNS[i])) return false;
+    }
+    return true;
+}
+
+static constexpr bool rangesValid() {
+    for (int tier = 0; tier < TrafficGenerator::TIERS; tier++) {
+        const PatternRange& range = TIER_PATTERNS[tier];
+        if (range.count < 1 || range.first < 0 || range.first + range.count > PATTERN_COUNT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(allFair(), "every traffic pattern must keep a lane free and coins out of cars");
+static_assert(rangesValid(), "every tier needs patterns inside the table");
+
+// Flips lane bits left to right (mirroring keeps a pattern fair)
+static uint8_t mirrorCars(uint8_t cars) {
+    uint8_t mirrored = 0;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        if ((cars >> lane) & 1) mirrored |= 1 << (LANE_COUNT - 1 - lane);
+    }
+    return mirrored;
+}
+
+bool TrafficGenerator::isValid(const TrafficCursor& cursor) {
+    return cursor.pattern >= 0 && cursor.pattern < PATTERN_COUNT &&
+        cursor.row >= 0 && cursor.row <= PATTERNS[cursor.pattern].rowCount &&
+        (cursor.lastCars & ~ALL_LANES) == 0;
+}
+
+void TrafficGenerator::reset() {
+    cursor = TrafficCursor();
+    cursor.row = PATTERNS[0].rowCount; // Used up; no last row, so any lane may be the player's
+}
+
+bool TrafficGenerator::atChunkEnd() const {
+    return cursor.row >= PATTERNS[cursor.pattern].rowCount;
+}
+
+bool TrafficGenerator::atChunkStart() const {
+    return cursor.row == 0;
+}
+
+void TrafficGenerator::startChunk(Rng& rng, int tier) {
+    assert(atChunkEnd() && tier >= 0 && tier < TIERS);
+    const PatternRange& range = TIER_PATTERNS[tier];
+    cursor.pattern = range.first + rng.nextInt(range.count);
+    cursor.row = 0;
+    cursor.mirrored = rng.nextInt(2) != 0;
+}
+
+PatternRow TrafficGenerator::next() {
+    assert(!atChunkEnd());
+    PatternRow row = PATTERNS[cursor.pattern].rows[cursor.row++];
+    if (cursor.mirrored) {
+        row.cars = mirrorCars(row.cars);
+        if (row.coinLane >= 0) row.coinLane = (int8_t)(LANE_COUNT - 1 - row.coinLane);
+    }
+    cursor.lastCars = row.cars;
+    return row;
+}
+
+int TrafficGenerator::lanesToCross() const {
+    const TrafficPattern& pattern = PATTERNS[cursor.pattern];
+    int taken = 0;
+    for (int r = cursor.row; r < pattern.rowCount; r++) {
+        taken |= pattern.rows[r].cars;
+    }
+    if (cursor.mirrored) taken = mirrorCars((uint8_t)taken);
+
+    // The worst free lane of the last row, measured to the nearest lane
+    // that the rest of the chunk keeps free
+    int worst = 0;
+    for (int from = 0; from < LANE_COUNT; from++) {
+        if ((cursor.lastCars >> from) & 1) continue;
+        int nearest = LANE_COUNT;
+        for (int to = 0; to < LANE_COUNT; to++) {
+            if (!((taken >> to) & 1)) nearest = std::min(nearest, std::abs(to - from));
+        }
+        worst = std::max(worst, nearest);
+    }
+    return worst;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef TRAFFIC_H
+#define TRAFFIC_H
+
+#include <cstdint>
+#include "constants.h"
+#include "rng.h"
+
+// One row of a traffic pattern: a car in every lane whose bit is set (bit 0
+// is the leftmost lane) and optionally a coin in one of the free lanes
+struct PatternRow {
+    uint8_t cars;
+    int8_t coinLane; // -1 for no coin
+};
+
+// A chunk of traffic: rows that enter the road one after another. Every
+// pattern keeps at least one lane free in all of its rows, so staying in
+// that lane always gets the player through; traffic.cpp checks the whole
+// table at compile time.
+struct TrafficPattern {
+    static const int MAX_ROWS = 4;
+    int rowCount;
+    PatternRow rows[MAX_ROWS];
+};
+
+// Where the generator is in the pattern stream. Plain data so that it can
+// be part of a Highway snapshot.
+struct TrafficCursor {
+    int pattern = 0;
+    int row = 0;
+    bool mirrored = false; // Pattern is played with its lanes flipped
+    uint8_t lastCars = 0;  // Lanes taken in the last row handed out
+};
+
+// Streams rows from one of a few pattern tables, sparse to dense (each
+// level picks one; see levels.h). Picking the next chunk is one table lookup
+// and one random number; rows are then read straight out of the table.
+class TrafficGenerator {
+public:
+    static const int TIERS = 3;
+
+    void reset(); // The next row starts a new chunk
+    bool atChunkEnd() const;   // Whether the current chunk is used up
+    bool atChunkStart() const; // Whether the next row opens the current chunk
+
+    // Picks the next chunk from tier's table; only at the chunk end
+    void startChunk(Rng& rng, int tier);
+    // Returns the next row to spawn from the current chunk, which must not
+    // be used up
+    PatternRow next();
+    // Lanes the player may have to cross between the last row handed out
+    // (whichever of its free lanes they took) and a lane that stays free
+    // through the whole current chunk; call at the chunk start
+    int lanesToCross() const;
+
+    const TrafficCursor& getCursor() const { return cursor; }
+    void setCursor(const TrafficCursor& value) { cursor = value; }
+    static bool isValid(const TrafficCursor& cursor); // Points into the table
+
+private:
+    TrafficCursor cursor;
+};
+
+#endif // TRAFFIC_H
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer/single-consumer hand-off of the latest value.
+// The writer fills writeSlot() and publish()es it; the reader calls update()
+// and then reads read(). Each side owns one slot and the third is swapped
+// between them atomically, so neither side ever waits for the other and the
+// reader always sees the newest complete value (older ones are dropped).
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : writeIndex(0), readIndex(1), middle(2) {}
+
+    // Direct access for preparing the slots before either thread starts
+    T& slot(int index) { return slots[index]; }
+
+    // Writer side
+    T& writeSlot() { return slots[writeIndex]; }
+    void publish() {
+        int previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side: swaps in the newest published value, if there is one.
+    // Returns whether read() changed.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+    const T& read() const { return slots[readIndex]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4; // Set on middle when the writer published since the last update()
+
+    T slots[3];
+    int writeIndex;          // Owned by the writer
+    int readIndex;           // Owned by the reader
+    std::atomic<int> middle; // Slot in transit, plus the FRESH flag
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+};
+
+#endif // TRIPLEBUFFER_H
\ No newline at end of file